@@ -0,0 +1,224 @@
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+#include "syntheticrepo.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScrollBar>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTreeWidgetItemIterator>
+
+#include <algorithm>
+#include <functional>
+
+// Drives MainWindow's private pipeline directly; declared a friend there.
+class NafudaBench
+{
+public:
+    NafudaBench(MainWindow &window, const QString &rootDir, int iterations)
+        : w(window), root(rootDir), iterations(iterations) {}
+
+    void runAll(int selectCount, int previewCount) {
+        // A fresh window from construction until its deferred startup work
+        // has run after the first paint. Target: well under 200 ms.
+        measure("time_to_interactive", [&]() {
+            MainWindow window;
+            bool ready = false;
+            QObject::connect(&window, &MainWindow::interactive, [&ready]() { ready = true; });
+            window.show();
+            QElapsedTimer timeout;
+            timeout.start();
+            while (!ready && timeout.elapsed() < 5000) QApplication::processEvents();
+        });
+
+        measure("scan", [&]() { w.loadProject(root); });
+        measure("tree_render", [&]() { w.generateAsciiTree(w.treeOptions); });
+        measure("select_all", [&]() { w.selectAllFiles(); });
+        measure("deselect_all", [&]() { w.deselectAllFiles(); });
+        measure("select_subset", [&]() { w.deselectAllFiles(); selectFirst(selectCount); });
+        measure("context_assembly", [&]() { w.renderSelectedFiles(); });
+        measure("copy_full_context", [&]() { w.copyFullContext(); });
+        measure("copy_delta_unchanged", [&]() { w.copyDelta(); });
+        measure("server_token_count", [&]() {
+            w.handleServerRequest(QJsonObject{{"cmd", "tokens"}, {"globs", QJsonArray{"**/*.cpp"}}});
+        });
+
+        QList<QTreeWidgetItem *> sample = leaves(previewCount);
+        measure("preview_load", [&]() {
+            for (QTreeWidgetItem *item : sample) w.onTreeItemClicked(item, 0);
+        }, sample.size());
+
+        // A 50k-line file paged through with the highlighter's time slices
+        // run between steps, as they would be between frames.
+        QString large;
+        for (int i = 0; i < 50000; ++i) large += QString("    int value%1 = compute(\"line %1\", 0x%1); // step %1\n").arg(i);
+        w.highlighter->setFileName("large.cpp");
+        w.ui->codeViewer->setPlainText(large);
+        QScrollBar *bar = w.ui->codeViewer->verticalScrollBar();
+        const int step = qMax(1, bar->pageStep()) * 25;
+        measure("preview_scroll", [&]() {
+            for (int v = bar->minimum(); v <= bar->maximum(); v += step) {
+                bar->setValue(v);
+                QCoreApplication::processEvents();
+            }
+        }, bar->maximum() / step + 1);
+        w.ui->codeViewer->clear();
+
+        // The top-level directories opened as one workspace, scanned in parallel.
+        QStringList roots;
+        for (const QFileInfo &info : QDir(root).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            roots << info.absoluteFilePath();
+        }
+        if (roots.size() > 1) measure("scan_workspace", [&]() { w.loadWorkspace(roots); });
+    }
+
+    QJsonArray results() const { return stages; }
+
+private:
+    MainWindow &w;
+    QString root;
+    int iterations;
+    QJsonArray stages;
+
+    void measure(const QString &stage, const std::function<void()> &fn, int perRun = 1) {
+        QList<double> samples;
+        for (int i = 0; i < iterations; ++i) {
+            QElapsedTimer timer;
+            timer.start();
+            fn();
+            QApplication::processEvents();
+            samples << timer.nsecsElapsed() / 1e6 / qMax(1, perRun);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        QJsonObject obj;
+        obj["stage"] = stage;
+        obj["iterations"] = iterations;
+        obj["min_ms"] = samples.first();
+        obj["median_ms"] = samples.at(samples.size() / 2);
+        obj["max_ms"] = samples.last();
+        if (perRun > 1) obj["per"] = QString("file (%1 files)").arg(perRun);
+        stages.append(obj);
+    }
+
+    QList<QTreeWidgetItem *> leaves(int limit) {
+        QList<QTreeWidgetItem *> out;
+        QTreeWidgetItemIterator it(w.ui->treeWidget);
+        while (*it && out.size() < limit) {
+            if ((*it)->childCount() == 0) out << *it;
+            ++it;
+        }
+        return out;
+    }
+
+    void selectFirst(int count) {
+        for (QTreeWidgetItem *item : leaves(count)) item->setCheckState(0, Qt::Checked);
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("nafuda_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Nafuda performance benchmark on a synthetic project tree.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"preset", "Tree size preset: small (~10k files), medium (~100k), large (~1M).", "name", "small"},
+        {"root", "Generate into (or reuse with --no-generate) this directory instead of a temp dir.", "dir"},
+        {"no-generate", "Benchmark the existing tree at --root."},
+        {"depth", "Directory depth.", "n"},
+        {"fanout", "Subdirectories per directory.", "n"},
+        {"files-per-dir", "Files per directory.", "n"},
+        {"min-size", "Minimum file size in bytes.", "bytes"},
+        {"max-size", "Maximum file size in bytes.", "bytes"},
+        {"binary-ratio", "Fraction of binary files (0-1).", "ratio"},
+        {"ignored-ratio", "Extra dot-directory files per directory, as a fraction of files-per-dir.", "ratio"},
+        {"seed", "Generator seed.", "n"},
+        {"iterations", "Timed runs per stage.", "n", "3"},
+        {"select", "Files selected for context assembly.", "n", "500"},
+        {"preview", "Files opened for preview timing.", "n", "200"},
+        {"output", "Write JSON results to this file instead of stdout.", "file"},
+    });
+    parser.process(app);
+
+    SyntheticRepoOptions options;
+    if (!SyntheticRepo::preset(parser.value("preset"), options)) {
+        qCritical("Unknown preset: %s", qPrintable(parser.value("preset")));
+        return 2;
+    }
+    if (parser.isSet("depth")) options.depth = parser.value("depth").toInt();
+    if (parser.isSet("fanout")) options.fanout = parser.value("fanout").toInt();
+    if (parser.isSet("files-per-dir")) options.filesPerDir = parser.value("files-per-dir").toInt();
+    if (parser.isSet("min-size")) options.minFileSize = parser.value("min-size").toLongLong();
+    if (parser.isSet("max-size")) options.maxFileSize = parser.value("max-size").toLongLong();
+    if (parser.isSet("binary-ratio")) options.binaryRatio = parser.value("binary-ratio").toDouble();
+    if (parser.isSet("ignored-ratio")) options.ignoredRatio = parser.value("ignored-ratio").toDouble();
+    if (parser.isSet("seed")) options.seed = parser.value("seed").toUInt();
+
+    // Keep the benchmark away from the user's real settings and recent list.
+    QTemporaryDir settingsDir;
+    QStandardPaths::setTestModeEnabled(true);
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, settingsDir.path());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, settingsDir.path());
+
+    QTemporaryDir tempRoot;
+    QString root = parser.isSet("root") ? QDir(parser.value("root")).absolutePath() : tempRoot.path();
+
+    QJsonObject report;
+    QJsonObject generator;
+    generator["depth"] = options.depth;
+    generator["fanout"] = options.fanout;
+    generator["files_per_dir"] = options.filesPerDir;
+    generator["min_size"] = double(options.minFileSize);
+    generator["max_size"] = double(options.maxFileSize);
+    generator["binary_ratio"] = options.binaryRatio;
+    generator["ignored_ratio"] = options.ignoredRatio;
+    generator["seed"] = double(options.seed);
+    report["generator"] = generator;
+
+    if (!parser.isSet("no-generate")) {
+        QElapsedTimer timer;
+        timer.start();
+        SyntheticRepoStats stats = SyntheticRepo::generate(root, options);
+        QJsonObject tree;
+        tree["dirs"] = double(stats.dirs);
+        tree["files"] = double(stats.files);
+        tree["binary_files"] = double(stats.binaryFiles);
+        tree["ignored_files"] = double(stats.ignoredFiles);
+        tree["bytes"] = double(stats.bytes);
+        tree["generate_ms"] = timer.nsecsElapsed() / 1e6;
+        report["tree"] = tree;
+    }
+
+    MainWindow window;
+    NafudaBench bench(window, root, qMax(1, parser.value("iterations").toInt()));
+    bench.runAll(parser.value("select").toInt(), parser.value("preview").toInt());
+    report["version"] = window.currentVersion;
+    report["results"] = bench.results();
+
+    QByteArray json = QJsonDocument(report).toJson();
+    if (parser.isSet("output")) {
+        QFile out(parser.value("output"));
+        if (!out.open(QIODevice::WriteOnly)) {
+            qCritical("Cannot write %s", qPrintable(parser.value("output")));
+            return 1;
+        }
+        out.write(json);
+    } else {
+        QFile out;
+        out.open(stdout, QIODevice::WriteOnly);
+        out.write(json);
+    }
+    return 0;
+}
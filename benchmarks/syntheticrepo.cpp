@@ -0,0 +1,124 @@
+#include "syntheticrepo.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QtMath>
+
+namespace {
+
+const char *const sourceLines[] = {
+    "#include \"module.h\"\n",
+    "import os\n",
+    "// Synthetic line used to pad generated sources to their target size.\n",
+    "static int counter = 0;\n",
+    "def handler(request, response):\n",
+    "    return response.status_code == 200\n",
+    "export function render(props) { return props.children; }\n",
+    "func (s *Server) Serve(ctx context.Context) error {\n",
+    "pub fn parse(input: &str) -> Result<Ast, Error> {\n",
+    "    for (int i = 0; i < count; ++i) total += values[i];\n",
+    "}\n",
+    "\n",
+    "/* block comment spanning a single line */\n",
+    "    const std::string label = \"value with // slashes\";\n",
+};
+const int sourceLineCount = int(sizeof(sourceLines) / sizeof(sourceLines[0]));
+
+const char *const textExtensions[] = {"cpp", "h", "py", "js", "ts", "go", "rs", "java", "md", "json"};
+const int textExtensionCount = int(sizeof(textExtensions) / sizeof(textExtensions[0]));
+
+struct Generator {
+    const SyntheticRepoOptions &options;
+    QRandomGenerator rng;
+    SyntheticRepoStats stats;
+
+    qint64 nextSize() {
+        // Log-uniform: many small files, a long tail of large ones.
+        double lo = qLn(double(qMax<qint64>(1, options.minFileSize)));
+        double hi = qLn(double(qMax(options.minFileSize, options.maxFileSize)));
+        return qint64(qExp(lo + rng.generateDouble() * (hi - lo)));
+    }
+
+    void writeFile(const QString &path, bool binary, qint64 size) {
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly)) return;
+
+        QByteArray data;
+        data.reserve(int(size));
+        if (binary) {
+            while (data.size() < size) {
+                quint32 word = rng.generate();
+                data.append(reinterpret_cast<const char *>(&word), 4);
+            }
+            data[0] = '\0';
+        } else {
+            while (data.size() < size) data.append(sourceLines[rng.bounded(sourceLineCount)]);
+        }
+        data.truncate(int(size));
+        f.write(data);
+
+        stats.files++;
+        stats.bytes += data.size();
+        if (binary) stats.binaryFiles++;
+    }
+
+    void fill(const QString &dirPath, int level) {
+        QDir dir(dirPath);
+        stats.dirs++;
+
+        for (int i = 0; i < options.filesPerDir; ++i) {
+            bool binary = rng.generateDouble() < options.binaryRatio;
+            QString name = binary ? QString("blob_%1.bin").arg(i)
+                                  : QString("file_%1.%2").arg(i).arg(textExtensions[rng.bounded(textExtensionCount)]);
+            writeFile(dir.filePath(name), binary, nextSize());
+        }
+
+        int ignored = int(options.filesPerDir * options.ignoredRatio);
+        if (ignored > 0) {
+            dir.mkdir(".cache");
+            for (int i = 0; i < ignored; ++i) {
+                writeFile(dir.filePath(QString(".cache/obj_%1.o").arg(i)), true, nextSize());
+                stats.ignoredFiles++;
+            }
+        }
+
+        if (level >= options.depth) return;
+        for (int i = 0; i < options.fanout; ++i) {
+            QString child = QString("dir_%1_%2").arg(level).arg(i);
+            dir.mkdir(child);
+            fill(dir.filePath(child), level + 1);
+        }
+    }
+};
+
+}
+
+bool SyntheticRepo::preset(const QString &name, SyntheticRepoOptions &options) {
+    // Presets target roughly 10k, 100k and 1M visible files.
+    if (name == "small") {
+        options.depth = 4;
+        options.fanout = 4;
+        options.filesPerDir = 30;
+    } else if (name == "medium") {
+        options.depth = 5;
+        options.fanout = 5;
+        options.filesPerDir = 26;
+    } else if (name == "large") {
+        options.depth = 6;
+        options.fanout = 6;
+        options.filesPerDir = 18;
+        options.maxFileSize = 16 * 1024;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+SyntheticRepoStats SyntheticRepo::generate(const QString &rootDir, const SyntheticRepoOptions &options) {
+    QDir().mkpath(rootDir);
+    Generator gen{options, QRandomGenerator(options.seed), SyntheticRepoStats()};
+    gen.fill(rootDir, 0);
+    return gen.stats;
+}
@@ -0,0 +1,35 @@
+#ifndef SYNTHETICREPO_H
+#define SYNTHETICREPO_H
+
+#include <QString>
+
+struct SyntheticRepoOptions {
+    int depth = 4;
+    int fanout = 4;
+    int filesPerDir = 30;
+    qint64 minFileSize = 256;
+    qint64 maxFileSize = 64 * 1024;
+    double binaryRatio = 0.05;
+    double ignoredRatio = 0.0;
+    quint32 seed = 42;
+};
+
+struct SyntheticRepoStats {
+    qint64 dirs = 0;
+    qint64 files = 0;
+    qint64 binaryFiles = 0;
+    qint64 ignoredFiles = 0;
+    qint64 bytes = 0;
+};
+
+// Deterministic generator for synthetic project trees. The same options and
+// seed always produce byte-identical trees, so timings stay comparable
+// across machines and releases.
+class SyntheticRepo
+{
+public:
+    static bool preset(const QString &name, SyntheticRepoOptions &options);
+    static SyntheticRepoStats generate(const QString &rootDir, const SyntheticRepoOptions &options);
+};
+
+#endif
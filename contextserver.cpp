@@ -0,0 +1,105 @@
+#include "contextserver.h"
+#include "profiler.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+
+ContextServer::ContextServer(Handler handler, QObject *parent)
+    : QObject(parent), server(new QLocalServer(this)), handler(std::move(handler))
+{
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server, &QLocalServer::newConnection, this, &ContextServer::onNewConnection);
+}
+
+QString ContextServer::defaultName() {
+    QString user = qEnvironmentVariable("USER", qEnvironmentVariable("USERNAME"));
+    return user.isEmpty() ? QString("nafuda") : "nafuda-" + user;
+}
+
+bool ContextServer::start(const QString &name) {
+    stop();
+    inUseBy.clear();
+
+    // Another instance may be serving under this name (named pipes on Windows
+    // even let a second server listen alongside it). Only a socket nobody
+    // answers on is stale, left behind by a crash on Unix, and safe to remove.
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(500)) {
+        probe.abort();
+        inUseBy = name;
+        return false;
+    }
+    QLocalServer::removeServer(name);
+    return server->listen(name);
+}
+
+void ContextServer::stop() {
+    if (server->isListening()) server->close();
+}
+
+bool ContextServer::isListening() const {
+    return server->isListening();
+}
+
+QString ContextServer::fullServerName() const {
+    return server->fullServerName();
+}
+
+QString ContextServer::errorString() const {
+    if (!inUseBy.isEmpty()) return "another instance is already serving " + inUseBy;
+    return server->errorString();
+}
+
+void ContextServer::onNewConnection() {
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+    }
+}
+
+void ContextServer::onReadyRead(QLocalSocket *socket) {
+    while (socket->canReadLine()) {
+        QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty()) continue;
+
+        QJsonObject reply;
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+        if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+            reply["ok"] = false;
+            reply["error"] = "invalid request: " + error.errorString();
+        } else {
+            Profiler::Scope scope("serverRequest");
+            QElapsedTimer timer;
+            timer.start();
+            reply = handler(doc.object());
+            reply["elapsedMs"] = timer.nsecsElapsed() / 1e6;
+        }
+        socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact) + "\n");
+    }
+}
+
+bool ContextServer::query(const QString &name, const QByteArray &request, QByteArray *reply, int timeoutMs) {
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (!socket.waitForConnected(timeoutMs)) {
+        *reply = socket.errorString().toUtf8();
+        return false;
+    }
+    socket.write(request.trimmed() + "\n");
+    socket.waitForBytesWritten(timeoutMs);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!socket.canReadLine()) {
+        if (!socket.waitForReadyRead(qMax<qint64>(1, timeoutMs - timer.elapsed()))) {
+            *reply = socket.errorString().toUtf8();
+            return false;
+        }
+    }
+    *reply = socket.readLine().trimmed();
+    return true;
+}
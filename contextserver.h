@@ -0,0 +1,44 @@
+#ifndef CONTEXTSERVER_H
+#define CONTEXTSERVER_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <functional>
+
+class QLocalServer;
+class QLocalSocket;
+
+// Local-only request server for editor integrations. Listens on a named
+// local socket (a Unix domain socket, or a named pipe on Windows) that only
+// the current user can open. Each request is one line of JSON and gets one
+// line of JSON back; the work itself is done by the handler.
+class ContextServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Handler = std::function<QJsonObject(const QJsonObject &)>;
+
+    explicit ContextServer(Handler handler, QObject *parent = nullptr);
+
+    bool start(const QString &name);
+    void stop();
+    bool isListening() const;
+    QString fullServerName() const;
+    QString errorString() const;
+
+    static QString defaultName();
+    static bool query(const QString &name, const QByteArray &request, QByteArray *reply, int timeoutMs = 30000);
+
+private slots:
+    void onNewConnection();
+
+private:
+    QLocalServer *server;
+    Handler handler;
+    QString inUseBy;
+
+    void onReadyRead(QLocalSocket *socket);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "copybaseline.h"
+#include "filecache.h"
+#include "profiler.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+static const quint32 baselineMagic = 0x4e464231; // "NFB1"
+
+QString CopyBaseline::storagePath(const QString &rootDir) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/Nafuda/baselines";
+    QString key = QString::number(FileCache::hashBytes(QDir::cleanPath(rootDir).toUtf8()), 16);
+    return dir + "/" + key + ".bin";
+}
+
+void CopyBaseline::load(const QString &root) {
+    Profiler::Scope scope("baselineLoad");
+    rootDir = root;
+    entries.clear();
+
+    QFile f(storagePath(root));
+    if (!f.open(QIODevice::ReadOnly)) return;
+    QDataStream in(qUncompress(f.readAll()));
+    in.setVersion(QDataStream::Qt_5_15);
+
+    quint32 magic = 0;
+    QString storedRoot;
+    qint32 count = 0;
+    in >> magic >> storedRoot >> count;
+    if (magic != baselineMagic || storedRoot != QDir::cleanPath(root)) return;
+
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString rel;
+        Entry e;
+        in >> rel >> e.sourceHash >> e.mode >> e.renderHash >> e.text;
+        entries.insert(rel, e);
+    }
+    if (in.status() != QDataStream::Ok) entries.clear();
+}
+
+void CopyBaseline::save() const {
+    Profiler::Scope scope("baselineSave");
+    if (rootDir.isEmpty()) return;
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << baselineMagic << QDir::cleanPath(rootDir) << qint32(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        out << it.key() << it->sourceHash << it->mode << it->renderHash << it->text;
+    }
+
+    QString path = storagePath(rootDir);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(qCompress(data, 1));
+        f.commit();
+    }
+}
+
+void CopyBaseline::replace(const QHash<QString, Entry> &copied) {
+    entries = copied;
+}
+
+void CopyBaseline::clear() {
+    entries.clear();
+}
+
+const CopyBaseline::Entry *CopyBaseline::find(const QString &relPath) const {
+    auto it = entries.constFind(relPath);
+    return it == entries.constEnd() ? nullptr : &it.value();
+}
@@ -0,0 +1,37 @@
+#ifndef COPYBASELINE_H
+#define COPYBASELINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+// What was pasted by the last copy of a project: per selected file, the hash
+// of its source bytes, the render settings it was produced with and the text
+// that went out. Kept on disk per project root so deltas survive restarts.
+class CopyBaseline
+{
+public:
+    struct Entry {
+        quint64 sourceHash = 0;
+        quint64 mode = 0;
+        quint64 renderHash = 0;
+        QString text;
+    };
+
+    void load(const QString &rootDir);
+    void save() const;
+    void replace(const QHash<QString, Entry> &copied);
+    void clear();
+
+    bool isEmpty() const { return entries.isEmpty(); }
+    const Entry *find(const QString &relPath) const;
+    QStringList paths() const { return entries.keys(); }
+
+private:
+    QString rootDir;
+    QHash<QString, Entry> entries;
+
+    static QString storagePath(const QString &rootDir);
+};
+
+#endif
@@ -0,0 +1,460 @@
+#include "dependencygraph.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+static const qint64 maxLexBytes = 512 * 1024;
+
+static QByteArray quotedAfter(const QByteArray &line, int from) {
+    for (int i = from; i < line.size(); ++i) {
+        char q = line.at(i);
+        if (q == '"' || q == '\'' || q == '`') {
+            int end = line.indexOf(q, i + 1);
+            if (end < 0) return QByteArray();
+            return line.mid(i + 1, end - i - 1);
+        }
+        if (q != ' ' && q != '\t' && q != '(') return QByteArray();
+    }
+    return QByteArray();
+}
+
+static bool isIdentChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' || c == '.';
+}
+
+static QString dirOf(const QString &relPath) {
+    int slash = relPath.lastIndexOf('/');
+    return slash < 0 ? QString() : relPath.left(slash);
+}
+
+static QString joinRel(const QString &dir, const QString &name) {
+    QString joined = dir.isEmpty() ? name : dir + "/" + name;
+    joined = QDir::cleanPath(joined);
+    if (joined == ".") return QString();
+    return joined;
+}
+
+void DependencyGraph::setSnapshot(const QString &root, const QStringList &filePaths) {
+    if (root != rootDir) cache.clear();
+    rootDir = root;
+    files.clear();
+    filesByName.clear();
+    goPackages.clear();
+
+    QDir dir(rootDir);
+    for (const QString &path : filePaths) addFile(dir.relativeFilePath(path));
+
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (files.contains(it.key())) ++it;
+        else it = cache.erase(it);
+    }
+}
+
+void DependencyGraph::addFile(const QString &rel) {
+    if (files.contains(rel)) return;
+    files.insert(rel);
+    filesByName[rel.mid(rel.lastIndexOf('/') + 1)] << rel;
+    if (rel.endsWith(".go") && !rel.endsWith("_test.go")) goPackages[dirOf(rel)] << rel;
+}
+
+void DependencyGraph::removeFiles(const QStringList &relPaths) {
+    for (const QString &rel : relPaths) {
+        if (!files.remove(rel)) continue;
+        cache.remove(rel);
+        const QString name = rel.mid(rel.lastIndexOf('/') + 1);
+        auto byName = filesByName.find(name);
+        if (byName != filesByName.end()) {
+            byName->removeOne(rel);
+            if (byName->isEmpty()) filesByName.erase(byName);
+        }
+        auto package = goPackages.find(dirOf(rel));
+        if (package != goPackages.end()) {
+            package->removeOne(rel);
+            if (package->isEmpty()) goPackages.erase(package);
+        }
+    }
+}
+
+void DependencyGraph::invalidate(const QString &dirPath) {
+    if (rootDir.isEmpty() || cache.isEmpty()) return;
+    QString rel = QDir(rootDir).relativeFilePath(dirPath);
+    if (rel == ".") rel.clear();
+
+    // The watcher reports directories, but only the files directly inside
+    // one can have changed; everything else in the cache is still good.
+    const QFileInfoList entries = QDir(dirPath).entryInfoList(QDir::Files);
+    for (const QFileInfo &info : entries) {
+        auto it = cache.find(joinRel(rel, info.fileName()));
+        if (it != cache.end() && it->modified != info.lastModified()) cache.erase(it);
+    }
+}
+
+void DependencyGraph::clear() {
+    rootDir.clear();
+    files.clear();
+    filesByName.clear();
+    goPackages.clear();
+    cache.clear();
+}
+
+const QList<DependencyGraph::Import> &DependencyGraph::importsFor(const QString &relPath) {
+    QFileInfo info(QDir(rootDir).filePath(relPath));
+    QDateTime modified = info.lastModified();
+
+    auto it = cache.find(relPath);
+    if (it != cache.end() && it->modified == modified) return it->imports;
+
+    Entry entry;
+    entry.modified = modified;
+    QFile f(info.filePath());
+    if (f.open(QIODevice::ReadOnly)) {
+        entry.imports = lex(relPath, f.read(maxLexBytes));
+    }
+    return cache.insert(relPath, entry)->imports;
+}
+
+QStringList DependencyGraph::dependencies(const QString &relPath) {
+    QStringList deps;
+    if (!files.contains(relPath)) return deps;
+
+    const QList<Import> imports = importsFor(relPath);
+    for (const Import &imp : imports) {
+        for (const QString &dep : resolve(relPath, imp)) {
+            if (dep != relPath && !deps.contains(dep)) deps << dep;
+        }
+    }
+    return deps;
+}
+
+QStringList DependencyGraph::closure(const QStringList &seeds, int maxDepth) {
+    QSet<QString> seen(seeds.begin(), seeds.end());
+    QStringList frontier = seeds;
+    QStringList added;
+
+    for (int depth = 0; depth < maxDepth && !frontier.isEmpty(); ++depth) {
+        QStringList next;
+        for (const QString &rel : frontier) {
+            for (const QString &dep : dependencies(rel)) {
+                if (seen.contains(dep)) continue;
+                seen.insert(dep);
+                added << dep;
+                next << dep;
+            }
+        }
+        frontier = next;
+    }
+    return added;
+}
+
+QStringList DependencyGraph::resolve(const QString &relPath, const Import &imp) const {
+    QString fromDir = dirOf(relPath);
+    QString hit;
+    switch (imp.kind) {
+    case CInclude: hit = resolveCInclude(fromDir, imp.spec); break;
+    case PythonModule: hit = resolvePython(fromDir, imp.spec); break;
+    case JsPath: hit = resolveJs(fromDir, imp.spec); break;
+    case GoPackage: return resolveGo(relPath, imp.spec);
+    case RustMod: hit = resolveRustMod(relPath, imp.spec); break;
+    case RustUse: hit = resolveRustUse(relPath, imp.spec); break;
+    }
+    return hit.isEmpty() ? QStringList() : QStringList{hit};
+}
+
+QString DependencyGraph::firstExisting(const QStringList &candidates) const {
+    for (const QString &c : candidates) {
+        if (!c.isEmpty() && files.contains(c)) return c;
+    }
+    return QString();
+}
+
+QString DependencyGraph::resolveCInclude(const QString &fromDir, const QString &spec) const {
+    QString hit = firstExisting({joinRel(fromDir, spec), QDir::cleanPath(spec)});
+    if (!hit.isEmpty()) return hit;
+
+    // Fall back to include-path style lookup: any project file whose path ends with the spec.
+    QString name = spec.mid(spec.lastIndexOf('/') + 1);
+    QString suffix = "/" + QDir::cleanPath(spec);
+    QString best;
+    for (const QString &candidate : filesByName.value(name)) {
+        if (!candidate.endsWith(suffix)) continue;
+        if (best.isEmpty() || candidate.size() < best.size()) best = candidate;
+    }
+    return best;
+}
+
+QString DependencyGraph::resolvePython(const QString &fromDir, const QString &spec) const {
+    int dots = 0;
+    while (dots < spec.size() && spec.at(dots) == '.') ++dots;
+    QString modulePath = spec.mid(dots).replace('.', '/');
+
+    QStringList bases;
+    if (dots > 0) {
+        QString base = fromDir;
+        for (int i = 1; i < dots; ++i) base = dirOf(base);
+        bases << base;
+    } else {
+        bases << QString() << fromDir << "src";
+    }
+
+    for (const QString &base : bases) {
+        if (modulePath.isEmpty()) {
+            QString hit = firstExisting({joinRel(base, "__init__.py")});
+            if (!hit.isEmpty()) return hit;
+            continue;
+        }
+        QString hit = firstExisting({joinRel(base, modulePath + ".py"), joinRel(base, modulePath + "/__init__.py")});
+        if (!hit.isEmpty()) return hit;
+    }
+    return QString();
+}
+
+QString DependencyGraph::resolveJs(const QString &fromDir, const QString &spec) const {
+    if (!spec.startsWith('.') && !spec.startsWith('/')) return QString();
+    QString base = spec.startsWith('/') ? QDir::cleanPath(spec.mid(1)) : joinRel(fromDir, spec);
+
+    static const QStringList exts = {".ts", ".tsx", ".d.ts", ".js", ".jsx", ".mjs", ".cjs", ".vue", ".svelte", ".json"};
+    QStringList candidates{base};
+    for (const QString &ext : exts) candidates << base + ext;
+    for (const QString &ext : exts) candidates << base + "/index" + ext;
+    // TypeScript ESM imports name the emitted ".js" file rather than the source.
+    if (base.endsWith(".js")) {
+        QString stem = base.left(base.size() - 3);
+        candidates << stem + ".ts" << stem + ".tsx";
+    }
+    return firstExisting(candidates);
+}
+
+QStringList DependencyGraph::resolveGo(const QString &relPath, const QString &spec) const {
+    QString best;
+    for (auto it = goPackages.constBegin(); it != goPackages.constEnd(); ++it) {
+        const QString &dir = it.key();
+        if (dir.isEmpty()) continue;
+        if (spec != dir && !spec.endsWith("/" + dir)) continue;
+        if (dir.size() > best.size()) best = dir;
+    }
+    if (best.isEmpty()) return QStringList();
+
+    QStringList deps = goPackages.value(best);
+    deps.removeAll(relPath);
+    return deps;
+}
+
+QString DependencyGraph::rustModuleDir(const QString &relPath) const {
+    QString fileName = relPath.mid(relPath.lastIndexOf('/') + 1);
+    QString dir = dirOf(relPath);
+    if (fileName == "mod.rs" || fileName == "lib.rs" || fileName == "main.rs") return dir;
+    return joinRel(dir, fileName.left(fileName.size() - 3));
+}
+
+QString DependencyGraph::resolveRustMod(const QString &relPath, const QString &name) const {
+    QString dir = rustModuleDir(relPath);
+    return firstExisting({joinRel(dir, name + ".rs"), joinRel(dir, name + "/mod.rs")});
+}
+
+QString DependencyGraph::resolveRustUse(const QString &relPath, const QString &spec) const {
+    QStringList segments = spec.split("::");
+    if (segments.size() < 2) return QString();
+
+    QString base;
+    QString head = segments.takeFirst();
+    if (head == "crate") {
+        base = dirOf(relPath);
+        while (true) {
+            if (files.contains(joinRel(base, "lib.rs")) || files.contains(joinRel(base, "main.rs"))) break;
+            if (base.isEmpty()) {
+                base = dirOf(relPath);
+                break;
+            }
+            base = dirOf(base);
+        }
+    } else if (head == "self") {
+        base = rustModuleDir(relPath);
+    } else if (head == "super") {
+        base = dirOf(rustModuleDir(relPath));
+        while (!segments.isEmpty() && segments.first() == "super") {
+            segments.removeFirst();
+            base = dirOf(base);
+        }
+    } else {
+        return QString();
+    }
+
+    // The tail of a use path is usually an item, not a module: try the longest module prefix first.
+    for (int n = segments.size(); n > 0; --n) {
+        QString modPath = segments.mid(0, n).join('/');
+        QString hit = firstExisting({joinRel(base, modPath + ".rs"), joinRel(base, modPath + "/mod.rs")});
+        if (!hit.isEmpty()) return hit;
+    }
+    return QString();
+}
+
+QList<DependencyGraph::Import> DependencyGraph::lex(const QString &relPath, const QByteArray &data) {
+    QList<Import> out;
+    QString ext = relPath.mid(relPath.lastIndexOf('.') + 1).toLower();
+
+    void (*lexLine)(const QByteArray &, QList<Import> &) = nullptr;
+    static const QSet<QString> cppExts = {"c", "h", "cc", "cpp", "cxx", "hpp", "hh", "hxx", "ipp", "inl", "m", "mm"};
+    static const QSet<QString> jsExts = {"js", "jsx", "mjs", "cjs", "ts", "tsx", "mts", "cts", "vue", "svelte"};
+    bool isGo = (ext == "go");
+    if (cppExts.contains(ext)) lexLine = lexCpp;
+    else if (ext == "py" || ext == "pyi") lexLine = lexPython;
+    else if (jsExts.contains(ext)) lexLine = lexJs;
+    else if (ext == "rs") lexLine = lexRust;
+    else if (!isGo) return out;
+
+    bool inGoBlock = false;
+    bool inBlockComment = false;
+    int start = 0;
+    while (start < data.size()) {
+        int end = data.indexOf('\n', start);
+        if (end < 0) end = data.size();
+        QByteArray line = data.mid(start, end - start).trimmed();
+        start = end + 1;
+
+        if (inBlockComment) {
+            int close = line.indexOf("*/");
+            if (close < 0) continue;
+            line = line.mid(close + 2).trimmed();
+            inBlockComment = false;
+        }
+        if (line.isEmpty() || line.startsWith("//")) continue;
+        if (line.startsWith("/*")) {
+            int close = line.indexOf("*/", 2);
+            if (close < 0) {
+                inBlockComment = true;
+                continue;
+            }
+            line = line.mid(close + 2).trimmed();
+        }
+
+        if (isGo) lexGo(line, inGoBlock, out);
+        else lexLine(line, out);
+    }
+    return out;
+}
+
+void DependencyGraph::lexCpp(const QByteArray &line, QList<Import> &out) {
+    if (!line.startsWith('#')) return;
+    QByteArray directive = line.mid(1).trimmed();
+    int from;
+    if (directive.startsWith("include")) from = 7;
+    else if (directive.startsWith("import")) from = 6;
+    else return;
+
+    int open = -1;
+    char close = 0;
+    for (int i = from; i < directive.size(); ++i) {
+        char c = directive.at(i);
+        if (c == '"') { open = i; close = '"'; break; }
+        if (c == '<') { open = i; close = '>'; break; }
+        if (c != ' ' && c != '\t') return;
+    }
+    if (open < 0) return;
+    int end = directive.indexOf(close, open + 1);
+    if (end < 0) return;
+    out.append({CInclude, QString::fromUtf8(directive.mid(open + 1, end - open - 1))});
+}
+
+void DependencyGraph::lexPython(const QByteArray &line, QList<Import> &out) {
+    if (line.startsWith("import ")) {
+        for (QByteArray part : line.mid(7).split(',')) {
+            part = part.trimmed();
+            int as = part.indexOf(" as ");
+            if (as >= 0) part = part.left(as).trimmed();
+            if (!part.isEmpty()) out.append({PythonModule, QString::fromUtf8(part)});
+        }
+    } else if (line.startsWith("from ")) {
+        int importPos = line.indexOf(" import ");
+        if (importPos < 0) return;
+        QByteArray module = line.mid(5, importPos - 5).trimmed();
+        if (module.isEmpty()) return;
+        out.append({PythonModule, QString::fromUtf8(module)});
+
+        // "from . import a, b" and "from pkg import mod" may name submodules.
+        QByteArray names = line.mid(importPos + 8);
+        names.replace('(', ' ').replace(')', ' ');
+        QString prefix = QString::fromUtf8(module);
+        if (!prefix.endsWith('.')) prefix += '.';
+        for (QByteArray name : names.split(',')) {
+            name = name.trimmed();
+            int as = name.indexOf(" as ");
+            if (as >= 0) name = name.left(as).trimmed();
+            if (name.isEmpty() || name == "*" || name.startsWith('#')) continue;
+            out.append({PythonModule, prefix + QString::fromUtf8(name)});
+        }
+    }
+}
+
+void DependencyGraph::lexJs(const QByteArray &line, QList<Import> &out) {
+    static const char *keywords[] = {"from", "import", "require(", "import("};
+    for (const char *keyword : keywords) {
+        int len = int(qstrlen(keyword));
+        int pos = 0;
+        while ((pos = line.indexOf(keyword, pos)) >= 0) {
+            bool boundary = (pos == 0) || !isIdentChar(line.at(pos - 1));
+            pos += len;
+            if (!boundary) continue;
+            QByteArray spec = quotedAfter(line, pos);
+            if (!spec.isEmpty()) out.append({JsPath, QString::fromUtf8(spec)});
+        }
+    }
+}
+
+void DependencyGraph::lexGo(const QByteArray &line, bool &inBlock, QList<Import> &out) {
+    if (inBlock) {
+        if (line.startsWith(')')) {
+            inBlock = false;
+            return;
+        }
+        int quote = line.indexOf('"');
+        if (quote >= 0) {
+            QByteArray spec = quotedAfter(line, quote);
+            if (!spec.isEmpty()) out.append({GoPackage, QString::fromUtf8(spec)});
+        }
+        return;
+    }
+    if (!line.startsWith("import")) return;
+    QByteArray rest = line.mid(6).trimmed();
+    if (rest.startsWith('(')) {
+        inBlock = true;
+        rest = rest.mid(1).trimmed();
+        if (rest.isEmpty()) return;
+        lexGo(rest, inBlock, out);
+        return;
+    }
+    int quote = rest.indexOf('"');
+    if (quote >= 0) {
+        QByteArray spec = quotedAfter(rest, quote);
+        if (!spec.isEmpty()) out.append({GoPackage, QString::fromUtf8(spec)});
+    }
+}
+
+void DependencyGraph::lexRust(const QByteArray &line, QList<Import> &out) {
+    QByteArray stmt = line;
+    if (stmt.startsWith("pub")) {
+        stmt = stmt.mid(3).trimmed();
+        if (stmt.startsWith('(')) {
+            int close = stmt.indexOf(')');
+            if (close < 0) return;
+            stmt = stmt.mid(close + 1).trimmed();
+        }
+    }
+
+    if (stmt.startsWith("mod ")) {
+        QByteArray name = stmt.mid(4).trimmed();
+        if (!name.endsWith(';')) return;
+        name.chop(1);
+        out.append({RustMod, QString::fromUtf8(name.trimmed())});
+    } else if (stmt.startsWith("use ")) {
+        QByteArray path = stmt.mid(4).trimmed();
+        int cut = path.size();
+        for (const char stop : {';', '{', ' ', '*'}) {
+            int idx = path.indexOf(stop);
+            if (idx >= 0 && idx < cut) cut = idx;
+        }
+        path = path.left(cut);
+        while (path.endsWith(':')) path.chop(1);
+        if (!path.isEmpty()) out.append({RustUse, QString::fromUtf8(path)});
+    }
+}
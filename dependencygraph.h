@@ -0,0 +1,70 @@
+#ifndef DEPENDENCYGRAPH_H
+#define DEPENDENCYGRAPH_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QList>
+
+// Lightweight include/import graph over the files of the loaded project.
+// Raw import specifiers are lexed once per file version and cached; they are
+// resolved against the current snapshot on every query, so files appearing or
+// disappearing are picked up without re-reading anything.
+class DependencyGraph
+{
+public:
+    void setSnapshot(const QString &rootDir, const QStringList &filePaths);
+    // Incremental updates mirroring ScanSnapshot::addFile/removeNodes.
+    void addFile(const QString &relPath);
+    void removeFiles(const QStringList &relPaths);
+    // Drops cached imports of the files directly in a changed directory
+    // whose modification time no longer matches.
+    void invalidate(const QString &dirPath);
+    void clear();
+
+    QStringList dependencies(const QString &relPath);
+    QStringList closure(const QStringList &seeds, int maxDepth);
+
+private:
+    enum ImportKind { CInclude, PythonModule, JsPath, GoPackage, RustMod, RustUse };
+
+    struct Import {
+        ImportKind kind;
+        QString spec;
+    };
+
+    struct Entry {
+        QDateTime modified;
+        QList<Import> imports;
+    };
+
+    QString rootDir;
+    QSet<QString> files;
+    QHash<QString, QStringList> filesByName;
+    QHash<QString, QStringList> goPackages;
+    QHash<QString, Entry> cache;
+
+    const QList<Import> &importsFor(const QString &relPath);
+    QStringList resolve(const QString &relPath, const Import &imp) const;
+
+    QString firstExisting(const QStringList &candidates) const;
+    QString resolveCInclude(const QString &fromDir, const QString &spec) const;
+    QString resolvePython(const QString &fromDir, const QString &spec) const;
+    QString resolveJs(const QString &fromDir, const QString &spec) const;
+    QStringList resolveGo(const QString &relPath, const QString &spec) const;
+    QString resolveRustMod(const QString &relPath, const QString &name) const;
+    QString resolveRustUse(const QString &relPath, const QString &spec) const;
+    QString rustModuleDir(const QString &relPath) const;
+
+    static QList<Import> lex(const QString &relPath, const QByteArray &data);
+    static void lexCpp(const QByteArray &line, QList<Import> &out);
+    static void lexPython(const QByteArray &line, QList<Import> &out);
+    static void lexJs(const QByteArray &line, QList<Import> &out);
+    static void lexGo(const QByteArray &line, bool &inBlock, QList<Import> &out);
+    static void lexRust(const QByteArray &line, QList<Import> &out);
+};
+
+#endif
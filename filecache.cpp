@@ -0,0 +1,87 @@
+#include "filecache.h"
+#include "profiler.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <cstring>
+
+static inline quint64 rotl64(quint64 x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline quint64 fmix64(quint64 k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+quint64 FileCache::hashBytes(const QByteArray &data) {
+    // MurmurHash3-style 64-bit mix over 8-byte words: fast, not cryptographic.
+    const quint64 c1 = 0x87c37b91114253d5ULL;
+    const quint64 c2 = 0x4cf5ad432745937fULL;
+    const char *p = data.constData();
+    qint64 len = data.size();
+    quint64 h = 0x9e3779b97f4a7c15ULL ^ quint64(len);
+
+    while (len >= 8) {
+        quint64 k;
+        std::memcpy(&k, p, 8);
+        k *= c1;
+        k = rotl64(k, 31);
+        k *= c2;
+        h ^= k;
+        h = rotl64(h, 27) * 5 + 0x52dce729;
+        p += 8;
+        len -= 8;
+    }
+
+    quint64 tail = 0;
+    for (qint64 i = len - 1; i >= 0; --i) tail = (tail << 8) | uchar(p[i]);
+    if (len > 0) {
+        tail *= c1;
+        tail = rotl64(tail, 31);
+        tail *= c2;
+        h ^= tail;
+    }
+    return fmix64(h);
+}
+
+bool FileCache::read(const QString &filePath, QByteArray *data) {
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    Profiler::instance().addCacheMiss();
+    // Stat before reading, so an edit racing the read leaves the entry stale.
+    Entry e;
+    e.modified = QFileInfo(filePath).lastModified();
+    *data = f.readAll();
+    Profiler::instance().addBytesRead(data->size());
+
+    e.size = data->size();
+    e.hash = hashBytes(*data);
+    entries.insert(filePath, e);
+    return true;
+}
+
+FileCache::Entry FileCache::lookup(const QString &filePath) const {
+    auto it = entries.constFind(filePath);
+    if (it != entries.constEnd()) {
+        QFileInfo info(filePath);
+        if (it->modified == info.lastModified() && it->size == info.size()) {
+            Profiler::instance().addCacheHit();
+            return *it;
+        }
+    }
+    return Entry();
+}
+
+void FileCache::invalidate(const QString &path) {
+    entries.remove(path);
+}
+
+void FileCache::clear() {
+    entries.clear();
+}
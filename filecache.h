@@ -0,0 +1,36 @@
+#ifndef FILECACHE_H
+#define FILECACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+
+// Per-file metadata remembered between copies. Files are hashed from the same
+// raw buffer that is rendered, and an entry stays valid while the file's
+// modification time and size are unchanged, so nothing is read just to hash.
+class FileCache
+{
+public:
+    struct Entry {
+        QDateTime modified;
+        qint64 size = -1;
+        quint64 hash = 0;
+    };
+
+    static quint64 hashBytes(const QByteArray &data);
+
+    // Reads the raw bytes once and records their hash.
+    bool read(const QString &filePath, QByteArray *data);
+    // The remembered entry while it is still valid, else one with size -1.
+    Entry lookup(const QString &filePath) const;
+    // Whatever was recorded last, without checking the file or counting a hit.
+    Entry recorded(const QString &filePath) const { return entries.value(filePath); }
+    void invalidate(const QString &path);
+    void clear();
+
+private:
+    QHash<QString, Entry> entries;
+};
+
+#endif
@@ -0,0 +1,641 @@
+#include "gitrepository.h"
+#include "globmatcher.h"
+#include "profiler.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+
+struct TreeEntry {
+    QByteArray mode;
+    QString name;
+    QByteArray sha;
+};
+
+inline quint32 be32(const uchar *p) {
+    return qFromBigEndian<quint32>(p);
+}
+
+inline bool isTree(const QByteArray &mode) {
+    return mode == "40000";
+}
+
+inline bool isGitlink(const QByteArray &mode) {
+    return mode == "160000";
+}
+
+// Inflates a zlib stream that may be followed by unrelated bytes (as inside a
+// packfile). qUncompress wants the expected size up front.
+QByteArray inflate(const uchar *data, qint64 len, quint32 expected) {
+    QByteArray buf;
+    buf.reserve(len + 4);
+    buf.append(char(expected >> 24)).append(char(expected >> 16)).append(char(expected >> 8)).append(char(expected));
+    buf.append(reinterpret_cast<const char *>(data), len);
+    return qUncompress(buf);
+}
+
+bool applyDelta(const QByteArray &base, const QByteArray &delta, QByteArray *out) {
+    const uchar *p = reinterpret_cast<const uchar *>(delta.constData());
+    const uchar *end = p + delta.size();
+    auto varint = [&](quint64 *value) {
+        *value = 0;
+        int shift = 0;
+        uchar c;
+        do {
+            if (p >= end) return false;
+            c = *p++;
+            *value |= quint64(c & 0x7f) << shift;
+            shift += 7;
+        } while (c & 0x80);
+        return true;
+    };
+
+    quint64 srcSize, dstSize;
+    if (!varint(&srcSize) || !varint(&dstSize) || srcSize != quint64(base.size())) return false;
+    out->clear();
+    out->reserve(dstSize);
+
+    while (p < end) {
+        uchar op = *p++;
+        if (op & 0x80) {
+            quint64 offset = 0;
+            quint64 size = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (!(op & (1 << i))) continue;
+                if (p >= end) return false;
+                offset |= quint64(*p++) << (8 * i);
+            }
+            for (int i = 0; i < 3; ++i) {
+                if (!(op & (0x10 << i))) continue;
+                if (p >= end) return false;
+                size |= quint64(*p++) << (8 * i);
+            }
+            if (size == 0) size = 0x10000;
+            if (offset + size > quint64(base.size())) return false;
+            out->append(base.constData() + offset, size);
+        } else if (op) {
+            if (p + op > end) return false;
+            out->append(reinterpret_cast<const char *>(p), op);
+            p += op;
+        } else {
+            return false;
+        }
+    }
+    return quint64(out->size()) == dstSize;
+}
+
+QVector<TreeEntry> parseTree(const QByteArray &data) {
+    QVector<TreeEntry> entries;
+    int pos = 0;
+    while (pos < data.size()) {
+        int space = data.indexOf(' ', pos);
+        int nul = data.indexOf('\0', space);
+        if (space < 0 || nul < 0 || nul + 21 > data.size()) break;
+        TreeEntry e;
+        e.mode = data.mid(pos, space - pos);
+        e.name = QString::fromUtf8(data.mid(space + 1, nul - space - 1));
+        e.sha = data.mid(nul + 1, 20);
+        entries.append(e);
+        pos = nul + 21;
+    }
+    return entries;
+}
+
+QByteArray blobSha(const QByteArray &content) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData("blob " + QByteArray::number(content.size()) + '\0');
+    hash.addData(content);
+    return hash.result();
+}
+
+QString shortRefName(const QString &ref) {
+    if (ref.startsWith("refs/heads/")) return ref.mid(11);
+    if (ref.startsWith("refs/remotes/")) return ref.mid(13);
+    return ref;
+}
+
+}
+
+bool GitRepository::open(const QString &path) {
+    QString projectDir = QFileInfo(path).canonicalFilePath();
+    QDir dir(projectDir);
+    forever {
+        QFileInfo dotGit(dir.filePath(".git"));
+        if (dotGit.isDir()) {
+            gitDir = dotGit.absoluteFilePath();
+            break;
+        }
+        if (dotGit.isFile()) {
+            // Linked worktrees and submodules: ".git" is a file pointing elsewhere.
+            QFile f(dotGit.absoluteFilePath());
+            QByteArray line = f.open(QIODevice::ReadOnly) ? f.readLine().trimmed() : QByteArray();
+            if (!line.startsWith("gitdir: ")) {
+                error = "Unreadable .git file in " + dir.path();
+                return false;
+            }
+            gitDir = QDir(dir.path()).absoluteFilePath(QString::fromUtf8(line.mid(8)));
+            break;
+        }
+        if (!dir.cdUp()) {
+            error = "Not a git repository";
+            return false;
+        }
+    }
+    workTree = dir.absolutePath();
+    gitDir = QDir::cleanPath(gitDir);
+
+    commonDir = gitDir;
+    QFile common(gitDir + "/commondir");
+    if (common.open(QIODevice::ReadOnly)) {
+        commonDir = QDir::cleanPath(QDir(gitDir).absoluteFilePath(QString::fromUtf8(common.readAll().trimmed())));
+    }
+
+    prefix = QDir(workTree).relativeFilePath(projectDir);
+    if (prefix == ".") prefix.clear();
+    return true;
+}
+
+bool GitRepository::onProjectPath(const QString &path) const {
+    return prefix.isEmpty() || path == prefix || path.startsWith(prefix + "/") || prefix.startsWith(path + "/");
+}
+
+QString GitRepository::toProject(const QString &path) const {
+    if (prefix.isEmpty()) return path;
+    if (path.startsWith(prefix + "/")) return path.mid(prefix.size() + 1);
+    return QString();
+}
+
+bool GitRepository::readIndex(QHash<QString, IndexEntry> *entries, qint64 *indexMtime) {
+    QFile f(gitDir + "/index");
+    if (!f.open(QIODevice::ReadOnly)) return true; // Fresh repository without an index.
+    const QByteArray data = f.readAll();
+    *indexMtime = QFileInfo(f).lastModified().toSecsSinceEpoch();
+    Profiler::instance().addBytesRead(data.size());
+
+    const uchar *d = reinterpret_cast<const uchar *>(data.constData());
+    const qint64 size = data.size();
+    if (size < 12 || !data.startsWith("DIRC")) {
+        error = "Unrecognized git index";
+        return false;
+    }
+    const quint32 version = be32(d + 4);
+    const quint32 count = be32(d + 8);
+    if (version < 2 || version > 4) {
+        error = QString("Unsupported git index version %1").arg(version);
+        return false;
+    }
+
+    entries->reserve(count);
+    qint64 pos = 12;
+    QByteArray name;
+    for (quint32 i = 0; i < count; ++i) {
+        const qint64 start = pos;
+        if (pos + 62 > size) break;
+        IndexEntry e;
+        e.mtimeSec = be32(d + pos + 8);
+        e.mtimeNsec = be32(d + pos + 12);
+        e.mode = be32(d + pos + 24);
+        e.size = be32(d + pos + 36);
+        e.sha = data.mid(pos + 40, 20);
+        const quint16 flags = qFromBigEndian<quint16>(d + pos + 60);
+        pos += 62;
+        if (version >= 3 && (flags & 0x4000)) pos += 2;
+
+        if (version == 4) {
+            // Path is stored as "drop N bytes from the previous path" plus a suffix.
+            if (pos >= size) break;
+            uchar c = d[pos++];
+            quint64 strip = c & 127;
+            while ((c & 128) && pos < size) {
+                c = d[pos++];
+                strip = ((strip + 1) << 7) | (c & 127);
+            }
+            int nul = data.indexOf('\0', pos);
+            if (nul < 0) break;
+            name = name.left(name.size() - int(qMin<quint64>(strip, name.size()))) + data.mid(pos, nul - pos);
+            pos = nul + 1;
+        } else {
+            int nul = data.indexOf('\0', pos);
+            if (nul < 0) break;
+            name = data.mid(pos, nul - pos);
+            pos = start + ((nul - start + 8) & ~7);
+        }
+
+        // Unmerged paths appear once per stage; an empty sha marks them as changed.
+        if ((flags >> 12) & 3) e.sha.clear();
+        entries->insert(QString::fromUtf8(name), e);
+    }
+    return true;
+}
+
+bool GitRepository::isWorkingCopyClean(const QString &path, const IndexEntry &entry, qint64 indexMtime) {
+    QFileInfo info(path);
+    if (!info.exists() || entry.sha.isEmpty()) return false;
+    if ((entry.mode & 0170000) == 0120000) return true;
+
+    const qint64 ms = info.lastModified().toMSecsSinceEpoch();
+    bool statMatch = entry.mtimeSec == quint32(ms / 1000)
+                     && (entry.mtimeNsec == 0 || entry.mtimeNsec / 1000000 == quint32(ms % 1000))
+                     && entry.size == quint32(info.size());
+    // An entry written in the same second as the index may hide a later edit.
+    bool racy = qint64(entry.mtimeSec) >= indexMtime;
+    if (statMatch && !racy) return true;
+    if (entry.size != quint32(info.size()) && !racy) return false;
+
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    QByteArray content = f.readAll();
+    Profiler::instance().addBytesRead(content.size());
+    if (blobSha(content) == entry.sha) return true;
+    // core.autocrlf checkouts: the blob holds LF line endings.
+    return content.contains("\r\n") && blobSha(content.replace("\r\n", "\n")) == entry.sha;
+}
+
+QByteArray GitRepository::resolveRef(const QString &name, QString *fullName, int depth) {
+    if (depth > 5) return QByteArray();
+    for (const QString &dir : {gitDir, commonDir}) {
+        QFile f(dir + "/" + name);
+        if (!f.open(QIODevice::ReadOnly)) continue;
+        QByteArray content = f.readAll().trimmed();
+        if (content.startsWith("ref: ")) return resolveRef(QString::fromUtf8(content.mid(5)), fullName, depth + 1);
+        if (content.size() == 40) {
+            if (fullName) *fullName = name;
+            return QByteArray::fromHex(content);
+        }
+    }
+
+    QFile packed(commonDir + "/packed-refs");
+    if (packed.open(QIODevice::ReadOnly)) {
+        const QByteArray target = name.toUtf8();
+        while (!packed.atEnd()) {
+            QByteArray line = packed.readLine().trimmed();
+            if (line.size() < 42 || line.startsWith('#') || line.startsWith('^')) continue;
+            if (line.mid(41) == target) {
+                if (fullName) *fullName = name;
+                return QByteArray::fromHex(line.left(40));
+            }
+        }
+    }
+    return QByteArray();
+}
+
+QByteArray GitRepository::resolveBase(const QString &baseBranch, QString *name) {
+    QStringList candidates;
+    if (!baseBranch.isEmpty()) {
+        candidates << "refs/heads/" + baseBranch << "refs/remotes/origin/" + baseBranch
+                   << "refs/remotes/" + baseBranch << baseBranch;
+    } else {
+        candidates << "refs/remotes/origin/HEAD" << "refs/heads/main" << "refs/heads/master"
+                   << "refs/remotes/origin/main" << "refs/remotes/origin/master";
+    }
+    for (const QString &candidate : candidates) {
+        QString full;
+        QByteArray sha = resolveRef(candidate, &full);
+        if (!sha.isEmpty()) {
+            *name = shortRefName(full);
+            return sha;
+        }
+    }
+    return QByteArray();
+}
+
+QVector<QByteArray> GitRepository::commitParents(const QByteArray &commit, QByteArray *tree) {
+    QVector<QByteArray> parents;
+    QByteArray type, data;
+    if (!readObject(commit, &type, &data) || type != "commit") return parents;
+
+    int pos = 0;
+    while (pos < data.size()) {
+        int eol = data.indexOf('\n', pos);
+        if (eol < 0 || eol == pos) break;
+        if (data.startsWith("tree ") && pos == 0) {
+            if (tree) *tree = QByteArray::fromHex(data.mid(5, 40));
+        } else if (data.mid(pos, 7) == "parent ") {
+            parents.append(QByteArray::fromHex(data.mid(pos + 7, 40)));
+        }
+        pos = eol + 1;
+    }
+    return parents;
+}
+
+QByteArray GitRepository::mergeBase(const QByteArray &a, const QByteArray &b) {
+    // Walk both histories breadth-first in lockstep; the first commit reached
+    // from both sides is the merge base for all but criss-cross histories.
+    if (a == b) return a;
+    QHash<QByteArray, int> seen;
+    seen.insert(a, 1);
+    seen.insert(b, 2);
+    QList<QByteArray> queues[2] = {{a}, {b}};
+
+    int budget = 200000;
+    while ((!queues[0].isEmpty() || !queues[1].isEmpty()) && budget-- > 0) {
+        for (int side = 0; side < 2; ++side) {
+            if (queues[side].isEmpty()) continue;
+            const int bit = side + 1;
+            for (const QByteArray &parent : commitParents(queues[side].takeFirst(), nullptr)) {
+                int &mark = seen[parent];
+                if (mark & bit) continue;
+                mark |= bit;
+                if (mark == 3) return parent;
+                queues[side].append(parent);
+            }
+        }
+    }
+    return QByteArray();
+}
+
+void GitRepository::flattenTree(const QByteArray &tree, const QString &path, QHash<QString, QByteArray> *out) {
+    QByteArray type, data;
+    if (tree.isEmpty() || !readObject(tree, &type, &data) || type != "tree") return;
+    for (const TreeEntry &e : parseTree(data)) {
+        QString child = path.isEmpty() ? e.name : path + "/" + e.name;
+        if (!onProjectPath(child) || isGitlink(e.mode)) continue;
+        if (isTree(e.mode)) flattenTree(e.sha, child, out);
+        else out->insert(child, e.sha);
+    }
+}
+
+void GitRepository::diffTrees(const QByteArray &oldTree, const QByteArray &newTree, const QString &path,
+                              QHash<QString, QByteArray> *changed) {
+    QByteArray type, data;
+    QHash<QString, TreeEntry> before;
+    if (!oldTree.isEmpty() && readObject(oldTree, &type, &data) && type == "tree") {
+        for (const TreeEntry &e : parseTree(data)) before.insert(e.name, e);
+    }
+    if (newTree.isEmpty() || !readObject(newTree, &type, &data) || type != "tree") return;
+
+    for (const TreeEntry &e : parseTree(data)) {
+        QString child = path.isEmpty() ? e.name : path + "/" + e.name;
+        if (!onProjectPath(child) || isGitlink(e.mode)) continue;
+        auto old = before.constFind(e.name);
+        bool hadOld = old != before.constEnd();
+        // Identical subtrees are skipped without being read.
+        if (hadOld && old->sha == e.sha && old->mode == e.mode) continue;
+
+        if (isTree(e.mode)) {
+            diffTrees(hadOld && isTree(old->mode) ? old->sha : QByteArray(), e.sha, child, changed);
+        } else {
+            changed->insert(child, hadOld && !isTree(old->mode) ? old->sha : QByteArray());
+        }
+    }
+}
+
+QStringList GitRepository::ignorePatterns(const QStringList &projectFiles) {
+    QSet<QString> dirs;
+    dirs.insert(QString());
+    for (const QString &rel : projectFiles) {
+        QString wt = prefix.isEmpty() ? rel : prefix + "/" + rel;
+        int slash = wt.lastIndexOf('/');
+        while (slash > 0) {
+            QString dir = wt.left(slash);
+            if (dirs.contains(dir)) break;
+            dirs.insert(dir);
+            slash = dir.lastIndexOf('/');
+        }
+    }
+
+    QStringList patterns;
+    auto collect = [&](const QString &file, const QString &dir) {
+        QFile f(file);
+        if (!f.open(QIODevice::ReadOnly)) return;
+        while (!f.atEnd()) {
+            QString line = QString::fromUtf8(f.readLine()).trimmed();
+            // Negated patterns are not supported; they are dropped rather than inverted.
+            if (line.isEmpty() || line.startsWith('#') || line.startsWith('!')) continue;
+            if (line.endsWith('/')) line.chop(1);
+            bool anchored = line.contains('/');
+            while (line.startsWith('/')) line.remove(0, 1);
+            if (line.isEmpty()) continue;
+            if (dir.isEmpty()) patterns << (anchored ? "/" + line : line);
+            else patterns << (anchored ? "/" + dir + "/" + line : "/" + dir + "/**/" + line);
+        }
+    };
+    collect(commonDir + "/info/exclude", QString());
+    for (const QString &dir : dirs) {
+        collect(dir.isEmpty() ? workTree + "/.gitignore" : workTree + "/" + dir + "/.gitignore", dir);
+    }
+    return patterns;
+}
+
+GitRepository::Changes GitRepository::changes(const Options &options, const QStringList &projectFiles) {
+    Profiler::Scope scope("gitChanges");
+    Changes result;
+
+    QHash<QString, IndexEntry> index;
+    qint64 indexMtime = 0;
+    if (!readIndex(&index, &indexMtime)) return result;
+
+    QString headRef;
+    const QByteArray head = resolveRef("HEAD", &headRef);
+    result.headName = head.isEmpty() ? QString() : shortRefName(headRef);
+    QByteArray headTree;
+    if (!head.isEmpty()) commitParents(head, &headTree);
+    QHash<QString, QByteArray> headFiles;
+    flattenTree(headTree, QString(), &headFiles);
+
+    for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+        const QString rel = toProject(it.key());
+        if (rel.isEmpty() || (it->mode & 0170000) == 0160000) continue;
+        const QString fullPath = workTree + "/" + it.key();
+
+        auto base = headFiles.constFind(it.key());
+        if (base != headFiles.constEnd()) result.baseBlobs.insert(rel, base.value());
+
+        if (options.staged && (base == headFiles.constEnd() || base.value() != it->sha) && QFileInfo::exists(fullPath)) {
+            result.staged << rel;
+        }
+        if (options.modified && !isWorkingCopyClean(fullPath, it.value(), indexMtime) && QFileInfo::exists(fullPath)) {
+            result.modified << rel;
+        }
+    }
+
+    if (options.untracked) {
+        GlobMatcher ignored(ignorePatterns(projectFiles));
+        for (const QString &rel : projectFiles) {
+            QString wt = prefix.isEmpty() ? rel : prefix + "/" + rel;
+            if (index.contains(wt)) continue;
+            bool skip = false;
+            for (int slash = wt.indexOf('/'); !skip; slash = wt.indexOf('/', slash + 1)) {
+                skip = ignored.matches(slash < 0 ? wt : wt.left(slash));
+                if (slash < 0) break;
+            }
+            if (!skip) result.untracked << rel;
+        }
+    }
+
+    if (options.branch && !head.isEmpty()) {
+        const QByteArray baseCommit = resolveBase(options.baseBranch, &result.baseName);
+        const QByteArray mergeCommit = baseCommit.isEmpty() ? QByteArray() : mergeBase(head, baseCommit);
+        if (!mergeCommit.isEmpty() && mergeCommit != head) {
+            QByteArray mergeTree;
+            commitParents(mergeCommit, &mergeTree);
+            QHash<QString, QByteArray> changed;
+            diffTrees(mergeTree, headTree, QString(), &changed);
+            for (auto it = changed.constBegin(); it != changed.constEnd(); ++it) {
+                const QString rel = toProject(it.key());
+                if (rel.isEmpty() || !QFileInfo::exists(workTree + "/" + it.key())) continue;
+                result.branch << rel;
+                if (it->isEmpty()) result.baseBlobs.remove(rel);
+                else result.baseBlobs.insert(rel, it.value());
+            }
+        } else if (baseCommit.isEmpty()) {
+            error = "No base branch found";
+        }
+    }
+
+    result.modified.sort();
+    result.staged.sort();
+    result.untracked.sort();
+    result.branch.sort();
+    return result;
+}
+
+QByteArray GitRepository::readBlob(const QByteArray &sha) {
+    QByteArray type, data;
+    if (!readObject(sha, &type, &data) || type != "blob") return QByteArray();
+    return data;
+}
+
+bool GitRepository::readObject(const QByteArray &sha, QByteArray *type, QByteArray *data, int depth) {
+    if (sha.size() != 20) return false;
+    return readLoose(sha, type, data) || readPacked(sha, type, data, depth);
+}
+
+bool GitRepository::readLoose(const QByteArray &sha, QByteArray *type, QByteArray *data) {
+    const QByteArray hex = sha.toHex();
+    QFile f(commonDir + "/objects/" + QString::fromLatin1(hex.left(2)) + "/" + QString::fromLatin1(hex.mid(2)));
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    const QByteArray raw = f.readAll();
+    Profiler::instance().addBytesRead(raw.size());
+
+    QByteArray object = inflate(reinterpret_cast<const uchar *>(raw.constData()), raw.size(), quint32(raw.size()) * 4);
+    int space = object.indexOf(' ');
+    int nul = object.indexOf('\0');
+    if (space < 0 || nul < space) return false;
+    *type = object.left(space);
+    *data = object.mid(nul + 1);
+    return true;
+}
+
+void GitRepository::loadPacks() {
+    packsLoaded = true;
+    QDir packDir(commonDir + "/objects/pack");
+    for (const QFileInfo &info : packDir.entryInfoList({"*.idx"}, QDir::Files)) {
+        QFile idxFile(info.absoluteFilePath());
+        if (!idxFile.open(QIODevice::ReadOnly)) continue;
+        Pack pack;
+        pack.idx = idxFile.readAll();
+        // Only version 2 indexes (git 1.5.2 and later) are read.
+        if (pack.idx.size() < 8 + 1024 || !pack.idx.startsWith("\377tOc") || be32(reinterpret_cast<const uchar *>(pack.idx.constData()) + 4) != 2) continue;
+
+        pack.file.reset(new QFile(info.absolutePath() + "/" + info.completeBaseName() + ".pack"));
+        if (!pack.file->open(QIODevice::ReadOnly)) continue;
+        pack.size = pack.file->size();
+        pack.data = pack.file->map(0, pack.size);
+        if (!pack.data) continue;
+        packs.append(pack);
+    }
+}
+
+bool GitRepository::readPacked(const QByteArray &sha, QByteArray *type, QByteArray *data, int depth) {
+    if (!packsLoaded) loadPacks();
+    const uchar first = uchar(sha.at(0));
+    for (int i = 0; i < packs.size(); ++i) {
+        const uchar *d = reinterpret_cast<const uchar *>(packs.at(i).idx.constData());
+        const quint32 count = be32(d + 8 + 255 * 4);
+        quint32 lo = first ? be32(d + 8 + (first - 1) * 4) : 0;
+        quint32 hi = be32(d + 8 + first * 4);
+        const uchar *shas = d + 8 + 1024;
+        if (qint64(8 + 1024) + qint64(count) * 28 > packs.at(i).idx.size()) continue;
+
+        while (lo < hi) {
+            quint32 mid = lo + (hi - lo) / 2;
+            int cmp = std::memcmp(shas + mid * 20, sha.constData(), 20);
+            if (cmp == 0) {
+                const uchar *offsets = shas + count * 24;
+                qint64 offset = be32(offsets + mid * 4);
+                if (offset & 0x80000000) {
+                    const uchar *large = offsets + count * 4 + (offset & 0x7fffffff) * 8;
+                    offset = qFromBigEndian<quint64>(large);
+                }
+                return readPackEntry(i, offset, type, data, depth);
+            }
+            if (cmp < 0) lo = mid + 1;
+            else hi = mid;
+        }
+    }
+    return false;
+}
+
+bool GitRepository::readPackEntry(int packIndex, qint64 offset, QByteArray *type, QByteArray *data, int depth) {
+    if (depth > 64) return false;
+    const QPair<int, qint64> key(packIndex, offset);
+    auto cached = baseCache.constFind(key);
+    if (cached != baseCache.constEnd()) {
+        *type = cached->type;
+        *data = cached->data;
+        return true;
+    }
+
+    const Pack &pack = packs.at(packIndex);
+    if (offset <= 0 || offset >= pack.size) return false;
+    const uchar *p = pack.data + offset;
+    const uchar *end = pack.data + pack.size;
+
+    uchar c = *p++;
+    const int kind = (c >> 4) & 7;
+    quint64 size = c & 15;
+    int shift = 4;
+    while ((c & 0x80) && p < end) {
+        c = *p++;
+        size |= quint64(c & 0x7f) << shift;
+        shift += 7;
+    }
+
+    QByteArray base;
+    if (kind == 6) {
+        if (p >= end) return false;
+        c = *p++;
+        quint64 back = c & 127;
+        while ((c & 128) && p < end) {
+            c = *p++;
+            back = ((back + 1) << 7) | (c & 127);
+        }
+        if (!readPackEntry(packIndex, offset - qint64(back), type, &base, depth + 1)) return false;
+    } else if (kind == 7) {
+        if (p + 20 > end) return false;
+        QByteArray baseSha(reinterpret_cast<const char *>(p), 20);
+        p += 20;
+        if (!readObject(baseSha, type, &base, depth + 1)) return false;
+    } else if (kind < 1 || kind > 4) {
+        return false;
+    }
+
+    // Deflate never expands data by more than a few bytes per 16K block.
+    const qint64 bound = qMin<qint64>(end - p, qint64(size) + qint64(size) / 16 + 64);
+    QByteArray inflated = inflate(p, bound, quint32(size));
+    Profiler::instance().addBytesRead(bound);
+    if (quint64(inflated.size()) != size) return false;
+
+    if (kind == 6 || kind == 7) {
+        if (!applyDelta(base, inflated, data)) return false;
+    } else {
+        static const char *const names[] = {"", "commit", "tree", "blob", "tag"};
+        *type = names[kind];
+        *data = inflated;
+    }
+
+    // Delta chains share their bases; keep recently resolved bases around.
+    if (depth > 0) {
+        if (baseCache.size() > 1024) baseCache.clear();
+        baseCache.insert(key, CachedObject{*type, *data});
+    }
+    return true;
+}
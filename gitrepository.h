@@ -0,0 +1,98 @@
+#ifndef GITREPOSITORY_H
+#define GITREPOSITORY_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QFile>
+#include <QSharedPointer>
+
+// Read-only access to a local git repository, straight from the .git
+// directory: the index, HEAD and refs, loose objects and packfiles. Nothing
+// is executed and nothing touches the network. Working-tree changes are found
+// from the stat data stored in the index; only files whose stat data differs
+// are read and hashed.
+class GitRepository
+{
+public:
+    struct Options {
+        bool modified = true;
+        bool staged = true;
+        bool untracked = true;
+        bool branch = true;
+        QString baseBranch;
+    };
+
+    // Paths are relative to the directory the repository was opened from.
+    struct Changes {
+        QStringList modified;
+        QStringList staged;
+        QStringList untracked;
+        QStringList branch;
+        QString headName;
+        QString baseName;
+        // Blob the changes of each path are measured against (HEAD, or the
+        // merge base when branch changes are included). New files have none.
+        QHash<QString, QByteArray> baseBlobs;
+    };
+
+    bool open(const QString &path);
+    QString errorString() const { return error; }
+
+    Changes changes(const Options &options, const QStringList &projectFiles);
+    QByteArray readBlob(const QByteArray &sha);
+
+private:
+    struct IndexEntry {
+        quint32 mtimeSec;
+        quint32 mtimeNsec;
+        quint32 size;
+        quint32 mode;
+        QByteArray sha;
+    };
+
+    struct Pack {
+        QByteArray idx;
+        QSharedPointer<QFile> file;
+        const uchar *data = nullptr;
+        qint64 size = 0;
+    };
+
+    struct CachedObject {
+        QByteArray type;
+        QByteArray data;
+    };
+
+    QString workTree;
+    QString gitDir;
+    QString commonDir;
+    QString prefix;
+    QString error;
+    QVector<Pack> packs;
+    bool packsLoaded = false;
+    QHash<QPair<int, qint64>, CachedObject> baseCache;
+
+    bool readIndex(QHash<QString, IndexEntry> *entries, qint64 *indexMtime);
+    QByteArray resolveRef(const QString &name, QString *fullName = nullptr, int depth = 0);
+    QByteArray resolveBase(const QString &baseBranch, QString *name);
+    QByteArray mergeBase(const QByteArray &a, const QByteArray &b);
+    QVector<QByteArray> commitParents(const QByteArray &commit, QByteArray *tree);
+    bool onProjectPath(const QString &path) const;
+    QString toProject(const QString &path) const;
+    void flattenTree(const QByteArray &tree, const QString &path, QHash<QString, QByteArray> *out);
+    void diffTrees(const QByteArray &oldTree, const QByteArray &newTree, const QString &path,
+                   QHash<QString, QByteArray> *changed);
+
+    bool readObject(const QByteArray &sha, QByteArray *type, QByteArray *data, int depth = 0);
+    bool readLoose(const QByteArray &sha, QByteArray *type, QByteArray *data);
+    bool readPacked(const QByteArray &sha, QByteArray *type, QByteArray *data, int depth);
+    bool readPackEntry(int pack, qint64 offset, QByteArray *type, QByteArray *data, int depth);
+    void loadPacks();
+    bool isWorkingCopyClean(const QString &path, const IndexEntry &entry, qint64 indexMtime);
+    QStringList ignorePatterns(const QStringList &projectFiles);
+};
+
+#endif
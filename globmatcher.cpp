@@ -0,0 +1,76 @@
+#include "globmatcher.h"
+
+GlobMatcher::GlobMatcher(const QStringList &patterns) {
+    // All patterns are compiled into a single alternation so a path is
+    // matched in one pass regardless of how many globs were given.
+    QStringList parts;
+    for (const QString &p : patterns) {
+        QString glob = p.trimmed();
+        if (glob.isEmpty()) continue;
+        parts << toRegex(glob);
+    }
+    if (parts.isEmpty()) return;
+    regex.setPattern("^(?:" + parts.join('|') + ")$");
+    regex.optimize();
+}
+
+bool GlobMatcher::matches(const QString &relPath) const {
+    if (isEmpty()) return false;
+    return regex.match(relPath).hasMatch();
+}
+
+QString GlobMatcher::toRegex(const QString &pattern) {
+    QString glob = pattern;
+    bool anchored = glob.startsWith('/') || glob.startsWith("./");
+    if (glob.startsWith("./")) glob.remove(0, 2);
+    while (glob.startsWith('/')) glob.remove(0, 1);
+    if (glob.endsWith('/')) glob += "**";
+
+    QString rx;
+    if (!anchored && !glob.contains('/')) rx += "(?:.*/)?";
+
+    const int n = glob.size();
+    for (int i = 0; i < n; ++i) {
+        QChar c = glob.at(i);
+        if (c == '*') {
+            if (i + 1 < n && glob.at(i + 1) == '*') {
+                ++i;
+                if (i + 1 < n && glob.at(i + 1) == '/') {
+                    ++i;
+                    rx += "(?:.*/)?";
+                } else {
+                    rx += ".*";
+                }
+            } else {
+                rx += "[^/]*";
+            }
+        } else if (c == '?') {
+            rx += "[^/]";
+        } else if (c == '[') {
+            int close = glob.indexOf(']', i + 1);
+            if (close < 0) {
+                rx += "\\[";
+                continue;
+            }
+            QString set = glob.mid(i + 1, close - i - 1);
+            if (set.startsWith('!')) set[0] = '^';
+            rx += "[" + set.replace("\\", "\\\\") + "]";
+            i = close;
+        } else if (c == '{') {
+            int close = glob.indexOf('}', i + 1);
+            if (close < 0) {
+                rx += "\\{";
+                continue;
+            }
+            QStringList alternatives;
+            for (const QString &alt : glob.mid(i + 1, close - i - 1).split(',')) {
+                alternatives << QRegularExpression::escape(alt);
+            }
+            rx += "(?:" + alternatives.join('|') + ")";
+            i = close;
+        } else {
+            rx += QRegularExpression::escape(QString(c));
+        }
+    }
+    return rx;
+}
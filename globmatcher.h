@@ -0,0 +1,27 @@
+#ifndef GLOBMATCHER_H
+#define GLOBMATCHER_H
+
+#include <QString>
+#include <QStringList>
+#include <QRegularExpression>
+
+// Matches project-relative paths against shell-style globs. "*" and "?" stay
+// within one path segment, "**" spans segments, and a pattern without a
+// slash matches the file name at any depth unless a leading slash anchors it
+// to the root (as in .gitignore).
+class GlobMatcher
+{
+public:
+    GlobMatcher() = default;
+    explicit GlobMatcher(const QStringList &patterns);
+
+    bool isEmpty() const { return !regex.isValid() || regex.pattern().isEmpty(); }
+    bool matches(const QString &relPath) const;
+
+    static QString toRegex(const QString &glob);
+
+private:
+    QRegularExpression regex;
+};
+
+#endif
@@ -1,13 +1,67 @@
 #include "mainwindow.h"
+#include "contextserver.h"
+#include "profiler.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QStyleFactory>
+#include <QTextStream>
+
+// Sends one request to a running context server and prints the reply.
+static int runQuery(const QString &serverName, const QString &request) {
+    QByteArray reply;
+    bool ok = ContextServer::query(serverName, request.toUtf8(), &reply);
+    QTextStream(ok ? stdout : stderr) << reply << "\n";
+    return ok ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
+    // Starts the profiler clock, so startup phases are timed from here.
+    Profiler::instance();
+
+    // The query client must work without a display, so it is dispatched
+    // before a QApplication is created.
+    for (int i = 1; i < argc; ++i) {
+        if (QByteArray(argv[i]) == "--query") {
+            QCoreApplication a(argc, argv);
+            QCommandLineParser parser;
+            parser.addOption(QCommandLineOption("query", "Send a JSON request to a running context server.", "json"));
+            parser.addOption(QCommandLineOption("server-name", "Local socket name of the context server.", "name", ContextServer::defaultName()));
+            parser.process(a);
+            return runQuery(parser.value("server-name"), parser.value("query"));
+        }
+    }
+
     QApplication a(argc, argv);
     a.setStyle(QStyleFactory::create("Fusion"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Nafuda - codebase context for language models");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("serve", "Run without a window and serve <dir> over the local context server.", "dir"));
+    parser.addOption(QCommandLineOption("query", "Send a JSON request to a running context server.", "json"));
+    parser.addOption(QCommandLineOption("server-name", "Local socket name of the context server.", "name", ContextServer::defaultName()));
+    parser.addOption(QCommandLineOption("trace-startup", "Print the time spent in each startup phase once the window is interactive."));
+    parser.process(a);
+
     MainWindow w;
-    w.show();
+    if (parser.isSet("trace-startup")) {
+        QObject::connect(&w, &MainWindow::interactive, []() {
+            Profiler &p = Profiler::instance();
+            QTextStream(stderr) << p.timeline("startup")
+                                << QString("time to interactive: %1 ms\n").arg(p.elapsedNs() / 1e6, 0, 'f', 1);
+        });
+    }
+    if (parser.isSet("serve")) {
+        if (!w.serveProject(parser.value("serve"), parser.value("server-name"))) {
+            QTextStream(stderr) << "nafuda: cannot serve " << parser.value("serve") << "\n";
+            return 1;
+        }
+        QTextStream(stdout) << "nafuda: serving " << parser.value("serve") << " on " << parser.value("server-name") << "\n";
+    } else {
+        Profiler::Scope showScope("startup.show");
+        w.show();
+    }
     return a.exec();
 }
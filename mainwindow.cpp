@@ -1,5 +1,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "profiler.h"
+#include "textdiff.h"
 
 #include <QApplication>
 #include <QFileDialog>
@@ -33,12 +35,24 @@
 #include <QPalette>
 #include <QCheckBox>
 #include <QSpinBox>
+#include <QMenu>
+#include <QLocale>
+#include <QTableWidget>
+#include <QJsonArray>
+#include <QLineEdit>
+
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
 {
-    ui->setupUi(this);
+    Profiler::Scope scope("startup.window");
+    {
+        Profiler::Scope uiScope("startup.setupUi");
+        ui->setupUi(this);
+    }
+    highlighter = new ViewportHighlighter(ui->codeViewer);
 
     ui->treeWidget->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
     ui->treeWidget->header()->setStretchLastSection(false);
@@ -58,6 +72,22 @@ MainWindow::MainWindow(QWidget *parent)
     statusFilterLabel->setStyleSheet("padding-right: 15px; color: #d97706; font-weight: bold; font-size: 11px;");
     ui->statusbar->addPermanentWidget(statusFilterLabel);
 
+    statusMinifyLabel = new QLabel(this);
+    statusMinifyLabel->setStyleSheet("padding-right: 15px; color: #059669; font-weight: bold; font-size: 11px;");
+    ui->statusbar->addPermanentWidget(statusMinifyLabel);
+
+    statusPrefixLabel = new QLabel(this);
+    statusPrefixLabel->setStyleSheet("padding-right: 15px; color: #555; font-size: 11px;");
+    statusPrefixLabel->hide();
+    ui->statusbar->addPermanentWidget(statusPrefixLabel);
+
+    statusDiagButton = new QToolButton(this);
+    statusDiagButton->setAutoRaise(true);
+    statusDiagButton->setToolTip("Open diagnostics");
+    statusDiagButton->setStyleSheet("font-size: 11px;");
+    ui->statusbar->addPermanentWidget(statusDiagButton);
+    connect(statusDiagButton, &QToolButton::clicked, this, &MainWindow::showDiagnostics);
+
     QList<int> sizes;
     sizes << 300 << 600 << 300;
     ui->splitter->setSizes(sizes);
@@ -69,47 +99,30 @@ MainWindow::MainWindow(QWidget *parent)
     ui->listWelcomeRecent->setFocusPolicy(Qt::NoFocus);
     ui->listWelcomeRecent->setCursor(Qt::PointingHandCursor);
 
-    QSettings settings("Nafuda", "Settings");
-    recentFiles = settings.value("recentFiles").toStringList();
-    updateRecentMenu();
-
-    filterDataFiles = settings.value("filterDataFiles", false).toBool();
-    maxDataLines = settings.value("maxDataLines", 10).toInt();
-    updateFilterStatus();
-
-    bool systemDark = false;
-#ifdef Q_OS_WIN
-    QSettings themeSettings("HKEY_CURRENT_USER\\Software\\Microsoft\\Windows\\CurrentVersion\\Themes\\Personalize", QSettings::NativeFormat);
-    if (themeSettings.value("AppsUseLightTheme", 1).toInt() == 0) {
-        systemDark = true;
+    // Only what the first frame shows is set up here; settings, the
+    // recent list, icons, the file watcher and the context server follow in
+    // finishStartup() once the window has painted.
+    netManager = nullptr;
+    fileWatcher = nullptr;
+    contextServer = nullptr;
+    serverRescanTimer = nullptr;
+    dedupCount = 0;
+    dedupBytes = 0;
+    statusDiagButton->hide();
+    ui->listWelcomeRecent->hide();
+    ui->lblRecentTitle->hide();
+
+    {
+        Profiler::Scope themeScope("startup.theme");
+        QSettings settings("Nafuda", "Settings");
+        // Until the user picks a theme the window follows the system one,
+        // which finishStartup() looks up once the window has painted.
+        bool isDark = settings.value("darkMode", false).toBool();
+        ui->actionDarkMode->setChecked(isDark);
+        applyTheme(isDark);
     }
-#endif
-    bool isDark = settings.value("darkMode", systemDark).toBool();
-    ui->actionDarkMode->setChecked(isDark);
-    toggleDarkMode(isDark);
-
     connect(ui->actionDarkMode, &QAction::toggled, this, &MainWindow::toggleDarkMode);
 
-    settings.beginGroup("Presets");
-    QStringList keys = settings.childKeys();
-    if (keys.isEmpty()) {
-        settings.endGroup();
-        QString oldTemplate = settings.value("template").toString();
-        if (oldTemplate.isEmpty()) oldTemplate = defaultTemplate;
-        presets.insert("Default", oldTemplate);
-        currentPresetName = "Default";
-    } else {
-        for (const QString &key : keys) {
-            presets.insert(key, settings.value(key).toString());
-        }
-        settings.endGroup();
-        currentPresetName = settings.value("currentPresetName", "Default").toString();
-        if (!presets.contains(currentPresetName) && !presets.isEmpty()) {
-            currentPresetName = presets.firstKey();
-        }
-    }
-    contentTemplate = presets.value(currentPresetName, defaultTemplate);
-
     connect(ui->btnWelcomeOpen, &QPushButton::clicked, this, &MainWindow::openFolder);
     connect(ui->listWelcomeRecent, &QListWidget::itemClicked, this, &MainWindow::onWelcomeListClicked);
 
@@ -119,8 +132,16 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->btnWarningReload, &QPushButton::clicked, this, &MainWindow::refreshProject);
 
     connect(ui->actionOpenFolder, &QAction::triggered, this, &MainWindow::openFolder);
+    connect(ui->actionAddWorkspaceFolder, &QAction::triggered, this, &MainWindow::addWorkspaceFolder);
     connect(ui->actionTemplateSettings, &QAction::triggered, this, &MainWindow::openTemplateOptions);
     connect(ui->actionDataFilterSettings, &QAction::triggered, this, &MainWindow::openDataFilterOptions);
+    connect(ui->actionDependencySettings, &QAction::triggered, this, &MainWindow::openDependencyOptions);
+    connect(ui->actionTraversalSettings, &QAction::triggered, this, &MainWindow::openTraversalOptions);
+    connect(ui->actionTreeSettings, &QAction::triggered, this, &MainWindow::openTreeOptions);
+    connect(ui->actionAddDependencies, &QAction::triggered, this, &MainWindow::addDependencies);
+    connect(ui->actionSelectGitChanges, &QAction::triggered, this, &MainWindow::selectGitChanges);
+    connect(ui->actionGitSettings, &QAction::triggered, this, &MainWindow::openGitOptions);
+    connect(ui->actionManageProfiles, &QAction::triggered, this, &MainWindow::openProfileOptions);
     connect(ui->actionAbout, &QAction::triggered, this, &MainWindow::showAbout);
     connect(ui->actionCheckUpdates, &QAction::triggered, this, &MainWindow::checkUpdate);
     connect(ui->actionExit, &QAction::triggered, qApp, &QApplication::quit);
@@ -130,20 +151,146 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->treeWidget, &QTreeWidget::itemClicked, this, &MainWindow::onTreeItemClicked);
     connect(ui->treeWidget, &QTreeWidget::itemChanged, this, &MainWindow::onTreeItemChanged);
     connect(ui->treeWidget, &QTreeWidget::currentItemChanged, this, &MainWindow::onCurrentItemChanged);
+    ui->treeWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->treeWidget, &QTreeWidget::customContextMenuRequested, this, &MainWindow::onTreeContextMenu);
 
     connect(ui->btnCopyTree, &QPushButton::clicked, this, &MainWindow::copyDirectoryTree);
     connect(ui->btnCopyContent, &QPushButton::clicked, this, &MainWindow::copyFileContent);
     connect(ui->btnCopyFull, &QPushButton::clicked, this, &MainWindow::copyFullContext);
+    connect(ui->btnCopyDelta, &QPushButton::clicked, this, &MainWindow::copyDelta);
+}
+
+void MainWindow::paintEvent(QPaintEvent *event) {
+    QMainWindow::paintEvent(event);
+    if (!startupFinished) QTimer::singleShot(0, this, &MainWindow::finishStartup);
+}
+
+void MainWindow::showEvent(QShowEvent *event) {
+    QMainWindow::showEvent(event);
+    // A window that starts minimized or covered may not paint for a while.
+    if (!startupFinished) QTimer::singleShot(500, this, &MainWindow::finishStartup);
+}
+
+void MainWindow::finishStartup() {
+    if (startupFinished) return;
+    startupFinished = true;
+    Profiler::Scope scope("startup.deferred");
+
+    QSettings settings("Nafuda", "Settings");
+#ifdef Q_OS_WIN
+    if (!settings.contains("darkMode")) {
+        Profiler::Scope themeScope("startup.systemTheme");
+        QSettings themeSettings("HKEY_CURRENT_USER\\Software\\Microsoft\\Windows\\CurrentVersion\\Themes\\Personalize", QSettings::NativeFormat);
+        if (themeSettings.value("AppsUseLightTheme", 1).toInt() == 0) {
+            // Not saved: only an explicit toggle pins the theme.
+            ui->actionDarkMode->blockSignals(true);
+            ui->actionDarkMode->setChecked(true);
+            ui->actionDarkMode->blockSignals(false);
+            applyTheme(true);
+        }
+    }
+#endif
+    {
+        Profiler::Scope settingsScope("startup.settings");
+        filterDataFiles = settings.value("filterDataFiles", false).toBool();
+        maxDataLines = settings.value("maxDataLines", 10).toInt();
+        updateFilterStatus();
+
+        dependencyDepth = settings.value("dependencyDepth", 3).toInt();
+
+        gitOptions.modified = settings.value("gitModified", true).toBool();
+        gitOptions.staged = settings.value("gitStaged", true).toBool();
+        gitOptions.untracked = settings.value("gitUntracked", true).toBool();
+        gitOptions.branch = settings.value("gitBranch", true).toBool();
+        gitOptions.baseBranch = settings.value("gitBaseBranch").toString();
+        gitHunksOnly = settings.value("gitHunksOnly", false).toBool();
+        gitHunkContext = settings.value("gitHunkContext", 3).toInt();
+
+        traversalPolicy.followSymlinks = settings.value("followSymlinks", true).toBool();
+        traversalPolicy.sameFilesystem = settings.value("sameFilesystem", true).toBool();
+        traversalPolicy.maxDepth = settings.value("maxTraversalDepth", 64).toInt();
+
+        treeOptions.maxLines = settings.value("treeMaxLines", 0).toInt();
+        treeOptions.maxTokens = settings.value("treeMaxTokens", 0).toInt();
+        treeOptions.maxDepth = settings.value("treeMaxDepth", 0).toInt();
+        treeOptions.maxEntriesPerDir = settings.value("treeMaxEntriesPerDir", 0).toInt();
+        treeOptions.selectedOnly = settings.value("treeSelectedOnly", false).toBool();
+
+        minifyOutput = settings.value("minifyOutput", false).toBool();
+        ui->actionMinifyOutput->setChecked(minifyOutput);
+        updateMinifyStatus();
+        connect(ui->actionMinifyOutput, &QAction::toggled, this, &MainWindow::toggleMinifyOutput);
+
+        stableOrder = settings.value("stableOrder", false).toBool();
+        ui->actionStableOrder->setChecked(stableOrder);
+        connect(ui->actionStableOrder, &QAction::toggled, this, &MainWindow::toggleStableOrder);
+
+        deltaAsDiff = settings.value("deltaAsDiff", true).toBool();
+        ui->actionDeltaDiffs->setChecked(deltaAsDiff);
+        connect(ui->actionDeltaDiffs, &QAction::toggled, this, &MainWindow::toggleDeltaDiffs);
+
+        bool showDiag = settings.value("showDiagnostics", false).toBool();
+        ui->actionShowDiagnostics->setChecked(showDiag);
+        statusDiagButton->setVisible(showDiag);
+        connect(ui->actionShowDiagnostics, &QAction::toggled, this, &MainWindow::toggleDiagnostics);
+
+        settings.beginGroup("Presets");
+        QStringList keys = settings.childKeys();
+        if (keys.isEmpty()) {
+            settings.endGroup();
+            QString oldTemplate = settings.value("template").toString();
+            if (oldTemplate.isEmpty()) oldTemplate = defaultTemplate;
+            presets.insert("Default", oldTemplate);
+            currentPresetName = "Default";
+        } else {
+            for (const QString &key : keys) {
+                presets.insert(key, settings.value(key).toString());
+            }
+            settings.endGroup();
+            currentPresetName = settings.value("currentPresetName", "Default").toString();
+            if (!presets.contains(currentPresetName) && !presets.isEmpty()) {
+                currentPresetName = presets.firstKey();
+            }
+        }
+        contentTemplate = presets.value(currentPresetName, defaultTemplate);
 
-    netManager = new QNetworkAccessManager(this);
-    connect(netManager, &QNetworkAccessManager::finished, this, &MainWindow::onUpdateResult);
+        settings.beginGroup("Profiles");
+        for (const QString &key : settings.childKeys()) {
+            profiles.insert(key, SelectionProfile::fromVariant(settings.value(key).toMap()));
+        }
+        settings.endGroup();
+        updateProfileMenu();
+    }
+
+    {
+        Profiler::Scope recentScope("startup.recent");
+        iconDir = QApplication::style()->standardIcon(QStyle::SP_DirIcon);
+        iconFile = QApplication::style()->standardIcon(QStyle::SP_FileIcon);
+        recentFiles = settings.value("recentFiles").toStringList();
+        updateRecentMenu();
+    }
+
+    {
+        Profiler::Scope watcherScope("startup.watcher");
+        fileWatcher = new QFileSystemWatcher(this);
+        connect(fileWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::onProjectModified);
+        connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::onProjectModified);
+    }
 
-    fileWatcher = new QFileSystemWatcher(this);
-    connect(fileWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::onProjectModified);
-    connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::onProjectModified);
+    {
+        Profiler::Scope serverScope("startup.server");
+        contextServer = new ContextServer([this](const QJsonObject &request) { return handleServerRequest(request); }, this);
+        serverRescanTimer = new QTimer(this);
+        serverRescanTimer->setSingleShot(true);
+        serverRescanTimer->setInterval(300);
+        connect(serverRescanTimer, &QTimer::timeout, this, &MainWindow::refreshProject);
+        if (settings.value("contextServer", false).toBool()) {
+            ui->actionContextServer->setChecked(startContextServer(ContextServer::defaultName()));
+        }
+        connect(ui->actionContextServer, &QAction::toggled, this, &MainWindow::toggleContextServer);
+    }
 
-    iconDir = QApplication::style()->standardIcon(QStyle::SP_DirIcon);
-    iconFile = QApplication::style()->standardIcon(QStyle::SP_FileIcon);
+    emit interactive();
 }
 
 MainWindow::~MainWindow() { delete ui; }
@@ -157,7 +304,292 @@ void MainWindow::updateFilterStatus() {
     }
 }
 
+void MainWindow::updateMinifyStatus() {
+    if (!minifyOutput) {
+        statusMinifyLabel->hide();
+        return;
+    }
+    if (minifyStats.bytesBefore == 0) {
+        statusMinifyLabel->setText("Minify: ON");
+    } else {
+        QLocale locale;
+        statusMinifyLabel->setText(QString("Minified: %1 → %2 (~%3 → ~%4 tokens)")
+                                       .arg(locale.formattedDataSize(minifyStats.bytesBefore))
+                                       .arg(locale.formattedDataSize(minifyStats.bytesAfter))
+                                       .arg(locale.toString(minifyStats.tokensBefore))
+                                       .arg(locale.toString(minifyStats.tokensAfter)));
+    }
+    statusMinifyLabel->show();
+}
+
+void MainWindow::toggleMinifyOutput(bool checked) {
+    minifyOutput = checked;
+    minifyStats = Minifier::Stats();
+    updateMinifyStatus();
+
+    QSettings settings("Nafuda", "Settings");
+    settings.setValue("minifyOutput", minifyOutput);
+
+    if (!currentFilePath.isEmpty()) {
+        showPreview(QDir(currentRootDir).relativeFilePath(currentFilePath));
+    }
+}
+
+void MainWindow::toggleStableOrder(bool checked) {
+    stableOrder = checked;
+    QSettings settings("Nafuda", "Settings");
+    settings.setValue("stableOrder", stableOrder);
+}
+
+void MainWindow::toggleContextServer(bool checked) {
+    if (checked) {
+        if (!startContextServer(ContextServer::defaultName())) {
+            QMessageBox::warning(this, "Local Context Server", "Could not start the server: " + contextServer->errorString());
+            ui->actionContextServer->blockSignals(true);
+            ui->actionContextServer->setChecked(false);
+            ui->actionContextServer->blockSignals(false);
+            return;
+        }
+        ui->statusbar->showMessage("Context server listening on " + contextServer->fullServerName(), 5000);
+    } else {
+        contextServer->stop();
+    }
+    QSettings settings("Nafuda", "Settings");
+    settings.setValue("contextServer", checked);
+}
+
+bool MainWindow::startContextServer(const QString &name) {
+    return contextServer->start(name);
+}
+
+bool MainWindow::serveProject(const QString &path, const QString &serverName) {
+    if (!QFileInfo(path).isDir()) return false;
+    finishStartup();
+    loadProject(QFileInfo(path).absoluteFilePath(), false);
+    return startContextServer(serverName);
+}
+
+QJsonObject MainWindow::handleServerRequest(const QJsonObject &request) {
+    QJsonObject reply;
+    const QString cmd = request.value("cmd").toString();
+
+    QString root = request.value("root").toString();
+    if (!root.isEmpty() && !projectRoots.contains(QDir::cleanPath(QFileInfo(root).absoluteFilePath()))) {
+        // Never switch projects on request: other clients, or someone working
+        // in the window, are relying on the one already loaded and indexed.
+        reply["ok"] = false;
+        reply["error"] = "root is not the loaded project: " + projectRoots.join(", ");
+        return reply;
+    }
+
+    if (cmd == "status") {
+        reply["ok"] = true;
+        reply["root"] = currentRootDir;
+        reply["roots"] = QJsonArray::fromStringList(projectRoots);
+        reply["files"] = snapshot.filePaths.size();
+        reply["dirs"] = snapshot.dirPaths.size();
+        reply["selected"] = ui->selectedListWidget->count();
+        reply["presets"] = QJsonArray::fromStringList(presets.keys());
+        return reply;
+    }
+    if (currentRootDir.isEmpty()) {
+        reply["ok"] = false;
+        reply["error"] = "no project loaded";
+        return reply;
+    }
+
+    // Files come from explicit paths, globs, or else the current selection.
+    QStringList files;
+    QSet<QString> seen;
+    const bool explicitFiles = request.contains("files") || request.contains("globs");
+    for (const QJsonValue &v : request.value("files").toArray()) {
+        QString rel = QDir::cleanPath(v.toString());
+        int node = snapshot.indexOf(rel);
+        if (node >= 0 && !snapshot.nodes.at(node).isDir && !seen.contains(rel)) {
+            seen.insert(rel);
+            files << rel;
+        }
+    }
+    QStringList globs;
+    for (const QJsonValue &v : request.value("globs").toArray()) globs << v.toString();
+    GlobMatcher matcher(globs);
+    if (!matcher.isEmpty()) {
+        for (const QString &rel : snapshot.relativeFiles()) {
+            if (!seen.contains(rel) && matcher.matches(rel)) {
+                seen.insert(rel);
+                files << rel;
+            }
+        }
+    }
+    files = explicitFiles ? orderFiles(files) : orderedSelection();
+
+    if (cmd == "tree") {
+        TreeRenderOptions options = treeOptions;
+        options.selectedOnly = false;
+        if (request.contains("maxLines")) options.maxLines = request.value("maxLines").toInt();
+        if (request.contains("maxTokens")) options.maxTokens = request.value("maxTokens").toInt();
+        if (request.contains("maxDepth")) options.maxDepth = request.value("maxDepth").toInt();
+        if (request.contains("maxEntriesPerDir")) options.maxEntriesPerDir = request.value("maxEntriesPerDir").toInt();
+
+        QSet<QString> selected;
+        QString path = QDir::cleanPath(request.value("path").toString());
+        if (!path.isEmpty() && path != ".") {
+            if (snapshot.indexOf(path) < 0) {
+                reply["ok"] = false;
+                reply["error"] = "no such path in project: " + path;
+                return reply;
+            }
+            options.selectedOnly = true;
+            for (const ScanSnapshot::Node &node : snapshot.nodes) {
+                if (!node.removed && (node.relPath == path || node.relPath.startsWith(path + "/"))) selected.insert(node.relPath);
+            }
+        } else if (explicitFiles) {
+            options.selectedOnly = true;
+            for (const QString &rel : files) selected.insert(rel);
+        }
+        reply["ok"] = true;
+        reply["text"] = QDir(currentRootDir).dirName() + "\n" + generateAsciiTree(options, selected);
+        return reply;
+    }
+
+    if (cmd == "context" || cmd == "tokens") {
+        QString tmpl = contentTemplate;
+        if (request.contains("preset")) {
+            QString preset = request.value("preset").toString();
+            if (!presets.contains(preset)) {
+                reply["ok"] = false;
+                reply["error"] = "unknown preset: " + preset;
+                return reply;
+            }
+            tmpl = presets.value(preset);
+        }
+        QString text = buildFullContext(files, tmpl);
+        reply["ok"] = true;
+        reply["files"] = files.size();
+        reply["tokens"] = Minifier::estimateTokens(text);
+        reply["bytes"] = Minifier::utf8Size(text);
+        if (cmd == "context") reply["text"] = text;
+        return reply;
+    }
+
+    reply["ok"] = false;
+    reply["error"] = "unknown command: " + cmd;
+    return reply;
+}
+
+void MainWindow::toggleDeltaDiffs(bool checked) {
+    deltaAsDiff = checked;
+    QSettings settings("Nafuda", "Settings");
+    settings.setValue("deltaAsDiff", deltaAsDiff);
+}
+
+void MainWindow::toggleDiagnostics(bool checked) {
+    statusDiagButton->setVisible(checked);
+    updateDiagnosticsStatus();
+
+    QSettings settings("Nafuda", "Settings");
+    settings.setValue("showDiagnostics", checked);
+}
+
+void MainWindow::updateDiagnosticsStatus() {
+    if (!statusDiagButton->isVisible()) return;
+
+    Profiler &profiler = Profiler::instance();
+    QString stage = profiler.lastStage();
+    if (stage.isEmpty()) {
+        statusDiagButton->setText("⏱ No timings yet");
+        return;
+    }
+
+    Profiler::StageStats s = profiler.stages().value(stage);
+    QString text = QString("⏱ %1: %2 ms").arg(stage).arg(s.lastNs / 1e6, 0, 'f', 1);
+    if (s.last.filesProcessed > 0) text += QString(" · %1 files").arg(s.last.filesProcessed);
+    if (s.last.bytesRead > 0) text += " · " + QLocale().formattedDataSize(s.last.bytesRead);
+    qint64 lookups = s.last.cacheHits + s.last.cacheMisses;
+    if (lookups > 0) text += QString(" · %1% cache hits").arg(100 * s.last.cacheHits / lookups);
+    statusDiagButton->setText(text);
+}
+
+void MainWindow::showDiagnostics() {
+    QDialog dlg(this);
+    dlg.setWindowTitle("Diagnostics");
+    dlg.resize(760, 360);
+    QVBoxLayout *layout = new QVBoxLayout(&dlg);
+
+    QTableWidget *table = new QTableWidget(&dlg);
+    table->setColumnCount(8);
+    table->setHorizontalHeaderLabels({"Stage", "Calls", "Last (ms)", "Total (ms)", "Max (ms)", "Files", "Bytes Read", "Cache Hit/Miss"});
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    layout->addWidget(table);
+
+    auto fill = [table]() {
+        const QMap<QString, Profiler::StageStats> stages = Profiler::instance().stages();
+        table->setRowCount(stages.size());
+        int row = 0;
+        for (auto it = stages.constBegin(); it != stages.constEnd(); ++it, ++row) {
+            const Profiler::StageStats &s = it.value();
+            QStringList cells = {
+                it.key(),
+                QString::number(s.calls),
+                QString::number(s.lastNs / 1e6, 'f', 2),
+                QString::number(s.totalNs / 1e6, 'f', 2),
+                QString::number(s.maxNs / 1e6, 'f', 2),
+                QString::number(s.total.filesProcessed),
+                QLocale().formattedDataSize(s.total.bytesRead),
+                QString("%1 / %2").arg(s.total.cacheHits).arg(s.total.cacheMisses)
+            };
+            for (int col = 0; col < cells.size(); ++col) table->setItem(row, col, new QTableWidgetItem(cells.at(col)));
+        }
+    };
+    fill();
+
+    auto exportData = [&dlg](const QString &title, const QString &fileName, const QByteArray &data) {
+        QString path = QFileDialog::getSaveFileName(&dlg, title, QDir::home().filePath(fileName), "JSON (*.json)");
+        if (path.isEmpty()) return;
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly) || f.write(data) != data.size()) {
+            QMessageBox::warning(&dlg, "Export Failed", "Could not write " + path);
+        }
+    };
+
+    QHBoxLayout *bottomLayout = new QHBoxLayout();
+    QPushButton *btnReset = new QPushButton("Reset", &dlg);
+    QPushButton *btnJson = new QPushButton("Export JSON...", &dlg);
+    QPushButton *btnTrace = new QPushButton("Export Chrome Trace...", &dlg);
+    QDialogButtonBox *btnBox = new QDialogButtonBox(QDialogButtonBox::Close, &dlg);
+    bottomLayout->addWidget(btnReset);
+    bottomLayout->addStretch();
+    bottomLayout->addWidget(btnJson);
+    bottomLayout->addWidget(btnTrace);
+    bottomLayout->addWidget(btnBox);
+    layout->addLayout(bottomLayout);
+
+    connect(btnReset, &QPushButton::clicked, [fill]() {
+        Profiler::instance().reset();
+        fill();
+    });
+    connect(btnJson, &QPushButton::clicked, [exportData]() {
+        exportData("Export Diagnostics", "nafuda-diagnostics.json", Profiler::instance().toJson());
+    });
+    connect(btnTrace, &QPushButton::clicked, [exportData]() {
+        exportData("Export Chrome Trace", "nafuda-trace.json", Profiler::instance().toChromeTrace());
+    });
+    connect(btnBox, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+
+    dlg.exec();
+    updateDiagnosticsStatus();
+}
+
 void MainWindow::toggleDarkMode(bool checked) {
+    applyTheme(checked);
+
+    QSettings settings("Nafuda", "Settings");
+    settings.setValue("darkMode", checked);
+}
+
+void MainWindow::applyTheme(bool checked) {
     if (checked) {
         QPalette darkPalette;
         darkPalette.setColor(QPalette::Window, QColor("#353535"));
@@ -235,6 +667,8 @@ void MainWindow::toggleDarkMode(bool checked) {
 
         statusPathLabel->setStyleSheet("padding-left: 5px; color: #ccc;");
         statusFilterLabel->setStyleSheet("padding-right: 15px; color: #fbbf24; font-weight: bold; font-size: 11px;");
+        statusMinifyLabel->setStyleSheet("padding-right: 15px; color: #34d399; font-weight: bold; font-size: 11px;");
+        statusPrefixLabel->setStyleSheet("padding-right: 15px; color: #ccc; font-size: 11px;");
 
     } else {
         qApp->setPalette(style()->standardPalette());
@@ -252,10 +686,11 @@ void MainWindow::toggleDarkMode(bool checked) {
 
         statusPathLabel->setStyleSheet("padding-left: 5px; color: #555;");
         statusFilterLabel->setStyleSheet("padding-right: 15px; color: #d97706; font-weight: bold; font-size: 11px;");
+        statusMinifyLabel->setStyleSheet("padding-right: 15px; color: #059669; font-weight: bold; font-size: 11px;");
+        statusPrefixLabel->setStyleSheet("padding-right: 15px; color: #555; font-size: 11px;");
     }
 
-    QSettings settings("Nafuda", "Settings");
-    settings.setValue("darkMode", checked);
+    highlighter->setDarkTheme(checked);
 }
 
 void MainWindow::setAllChildCheckState(QTreeWidgetItem *item, Qt::CheckState state) {
@@ -293,6 +728,7 @@ void MainWindow::selectAllFiles() {
         }
         ++it;
     }
+    refreshOutlineMarks();
 }
 
 void MainWindow::deselectAllFiles() {
@@ -309,6 +745,43 @@ void MainWindow::deselectAllFiles() {
     ui->selectedListWidget->clear();
 }
 
+void MainWindow::addDependencies() {
+    if (currentRootDir.isEmpty()) return;
+    if (ui->selectedListWidget->count() == 0) {
+        ui->lblStatus->setText("⚠ No files selected!");
+        QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+        return;
+    }
+
+    QStringList seeds;
+    for (int i = 0; i < ui->selectedListWidget->count(); ++i) {
+        seeds << ui->selectedListWidget->item(i)->text();
+    }
+
+    QStringList deps = depGraph.closure(seeds, dependencyDepth);
+    QSet<QString> wanted(deps.begin(), deps.end());
+
+    ui->treeWidget->setUpdatesEnabled(false);
+    ui->treeWidget->blockSignals(true);
+    QDir rootDir(currentRootDir);
+    QTreeWidgetItemIterator it(ui->treeWidget);
+    while (*it && !wanted.isEmpty()) {
+        if ((*it)->childCount() == 0) {
+            QString relPath = rootDir.relativeFilePath((*it)->data(0, Qt::UserRole).toString());
+            if (wanted.remove(relPath)) {
+                (*it)->setCheckState(0, Qt::Checked);
+                updateFileList(*it);
+            }
+        }
+        ++it;
+    }
+    ui->treeWidget->blockSignals(false);
+    ui->treeWidget->setUpdatesEnabled(true);
+
+    ui->lblStatus->setText(deps.isEmpty() ? "No new dependencies found" : QString("Added %1 dependencies").arg(deps.size()));
+    QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+}
+
 void MainWindow::openFolder() {
     QString dir = QFileDialog::getExistingDirectory(this, "Open Directory", QDir::homePath());
     if (!dir.isEmpty()) {
@@ -316,13 +789,61 @@ void MainWindow::openFolder() {
     }
 }
 
-void MainWindow::loadProject(const QString &path) {
+void MainWindow::addWorkspaceFolder() {
+    if (projectRoots.isEmpty()) return;
+    QString dir = QFileDialog::getExistingDirectory(this, "Add Folder to Workspace", QFileInfo(projectRoots.last()).absolutePath());
+    if (!dir.isEmpty()) {
+        loadWorkspace(projectRoots + QStringList{dir});
+    }
+}
+
+void MainWindow::loadProject(const QString &path, bool remember) {
+    loadWorkspace(QStringList{path}, remember);
+}
+
+// The headless server passes remember = false so that an editor integration
+// does not fill the user's recent list.
+void MainWindow::loadWorkspace(QStringList roots, bool remember) {
+    finishStartup();
+    Profiler::Scope scope("loadProject");
+    // A root inside another root is already part of the workspace.
+    for (QString &root : roots) root = QDir::cleanPath(root);
+    roots.removeDuplicates();
+    for (int i = roots.size() - 1; i >= 0; --i) {
+        for (const QString &other : roots) {
+            if (other != roots.at(i) && roots.at(i).startsWith(other.endsWith('/') ? other : other + "/")) {
+                roots.removeAt(i);
+                break;
+            }
+        }
+    }
+    if (roots.isEmpty()) return;
+    const QString path = (roots.size() == 1) ? roots.first() : ScanSnapshot::commonDir(roots);
+    if (path.isEmpty()) {
+        QMessageBox::warning(this, "Workspace", "Workspace folders must be on the same drive:\n" + roots.join("\n"));
+        return;
+    }
+
+    const QString key = roots.join('\n');
+    if (key != projectKey()) {
+        outlineFiles.clear();
+        outliner.clear();
+        fileCache.clear();
+        lastCopyOutput.clear();
+        baseline.load(key);
+        gitHunkBase.clear();
+        gitRepos.clear();
+    }
+    projectRoots = roots;
     currentRootDir = path;
-    addToRecent(path);
+    if (remember) addToRecent(key);
+    ui->actionAddWorkspaceFolder->setEnabled(true);
 
     QDir dir(path);
-    setWindowTitle(dir.dirName() + " - Nafuda");
-    statusPathLabel->setText("Loaded: " + path);
+    QStringList names;
+    for (const QString &root : roots) names << QDir(root).dirName();
+    setWindowTitle(names.join(" + ") + " - Nafuda");
+    statusPathLabel->setText("Loaded: " + roots.join(", "));
 
     ui->stackedWidget->setCurrentIndex(1);
 
@@ -337,8 +858,10 @@ void MainWindow::loadProject(const QString &path) {
     if (!fileWatcher->directories().isEmpty()) fileWatcher->removePaths(fileWatcher->directories());
     if (!fileWatcher->files().isEmpty()) fileWatcher->removePaths(fileWatcher->files());
 
-    QStringList watchDirs;
-    watchDirs << path;
+    {
+        Profiler::Scope scanScope("scan");
+        snapshot = ScanSnapshot::scanWorkspace(roots, traversalPolicy);
+    }
 
     QTreeWidgetItem *rootItem = new QTreeWidgetItem(ui->treeWidget);
     rootItem->setText(0, dir.dirName());
@@ -346,14 +869,30 @@ void MainWindow::loadProject(const QString &path) {
     rootItem->setData(0, Qt::UserRole, path);
     rootItem->setCheckState(0, Qt::Unchecked);
 
-    populateTree(path, rootItem, watchDirs);
+    {
+        Profiler::Scope populateScope("populateTree");
+        populateTree(0, rootItem);
+    }
     ui->treeWidget->expandItem(rootItem);
 
-    if (!watchDirs.isEmpty()) {
-        fileWatcher->addPaths(watchDirs);
+    statusPathLabel->setToolTip(QString());
+    if (!snapshot.skipSummary.isEmpty()) {
+        statusPathLabel->setText("Loaded: " + roots.join(", ") + "  (" + snapshot.skipSummary + ")");
+        statusPathLabel->setToolTip(snapshot.skipDetails.join("\n"));
+    }
+    depGraph.setSnapshot(path, snapshot.filePaths);
+
+    fileWatcher->addPaths(roots);
+    if (!snapshot.dirPaths.isEmpty()) {
+        fileWatcher->addPaths(snapshot.dirPaths);
     }
 
+    QSettings settings("Nafuda", "Settings");
+    QString profile = settings.value("ProjectProfiles/" + QString::number(FileCache::hashBytes(key.toUtf8()), 16)).toString();
+    applyProfile(profiles.contains(profile) ? profile : QString());
+
     ui->treeWidget->setUpdatesEnabled(true);
+    QTimer::singleShot(0, this, &MainWindow::updateDiagnosticsStatus);
 }
 
 void MainWindow::addToRecent(const QString &path) {
@@ -413,12 +952,18 @@ void MainWindow::updateRecentMenu() {
                 relativeTime = getRelativeTime(dt);
             }
 
-            QAction *action = ui->menuOpenRecent->addAction(path);
+            // Workspaces are stored as their roots joined by newlines.
+            QStringList roots = path.split('\n');
+            QStringList names;
+            for (const QString &root : roots) names << QDir(root).dirName();
+
+            QAction *action = ui->menuOpenRecent->addAction(roots.size() > 1 ? "Workspace: " + names.join(" + ") : path);
             action->setData(path);
+            action->setToolTip(roots.join("\n"));
             connect(action, &QAction::triggered, this, &MainWindow::openRecentProject);
 
             QListWidgetItem *item = new QListWidgetItem();
-            QString displayText = QDir(path).dirName();
+            QString displayText = names.join(" + ");
             if (!relativeTime.isEmpty()) {
                 displayText += "\n" + relativeTime;
             }
@@ -438,8 +983,9 @@ void MainWindow::openRecentProject() {
     QAction *action = qobject_cast<QAction *>(sender());
     if (action) {
         QString path = action->data().toString();
-        if (QDir(path).exists()) {
-            loadProject(path);
+        QStringList roots = path.split('\n');
+        if (std::all_of(roots.begin(), roots.end(), [](const QString &root) { return QDir(root).exists(); })) {
+            loadWorkspace(roots);
         } else {
             QMessageBox::warning(this, "Error", "Directory does not exist anymore.");
             for(int i=0; i<recentFiles.size(); ++i) {
@@ -457,8 +1003,9 @@ void MainWindow::openRecentProject() {
 
 void MainWindow::onWelcomeListClicked(QListWidgetItem *item) {
     QString path = item->data(Qt::UserRole).toString();
-    if (QDir(path).exists()) {
-        loadProject(path);
+    QStringList roots = path.split('\n');
+    if (std::all_of(roots.begin(), roots.end(), [](const QString &root) { return QDir(root).exists(); })) {
+        loadWorkspace(roots);
     } else {
         QMessageBox::warning(this, "Error", "Directory does not exist anymore.");
         for(int i=0; i<recentFiles.size(); ++i) {
@@ -480,23 +1027,24 @@ void MainWindow::clearRecentList() {
     updateRecentMenu();
 }
 
-void MainWindow::populateTree(const QString &path, QTreeWidgetItem *parentItem, QStringList &watchDirs) {
-    QDir dir(path);
-    dir.setFilter(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
-    dir.setSorting(QDir::DirsFirst | QDir::Name);
-    for (const QFileInfo &info : dir.entryInfoList()) {
-        if (info.fileName().startsWith(".")) continue;
+void MainWindow::populateTree(int node, QTreeWidgetItem *parentItem) {
+    for (int childIndex : snapshot.nodes.at(node).children) {
+        const ScanSnapshot::Node &child = snapshot.nodes.at(childIndex);
         QTreeWidgetItem *item = new QTreeWidgetItem(parentItem);
-        item->setText(0, info.fileName());
-        item->setData(0, Qt::UserRole, info.filePath());
+        item->setText(0, child.name);
+        item->setData(0, Qt::UserRole, snapshot.filePath(childIndex));
         item->setCheckState(0, Qt::Unchecked);
 
-        if (info.isDir()) {
+        if (child.isDir) {
             item->setIcon(0, iconDir);
-            watchDirs << info.filePath();
-            populateTree(info.filePath(), item, watchDirs);
+            populateTree(childIndex, item);
         } else {
             item->setIcon(0, iconFile);
+            if (!outlineFiles.isEmpty() && outlineFiles.contains(child.relPath)) {
+                QFont font = item->font(0);
+                font.setItalic(true);
+                item->setFont(0, font);
+            }
         }
     }
 }
@@ -521,7 +1069,7 @@ void MainWindow::onTreeItemClicked(QTreeWidgetItem *item, int column) {
         ui->lblFileInfo->setTextFormat(Qt::RichText);
         ui->lblFileInfo->setText(fileInfoText);
 
-        ui->codeViewer->setText(processFileContent(path));
+        showPreview(QDir(currentRootDir).relativeFilePath(path));
     } else {
         currentFilePath.clear();
         ui->lblFileInfo->setText("Folder: " + info.fileName());
@@ -530,6 +1078,23 @@ void MainWindow::onTreeItemClicked(QTreeWidgetItem *item, int column) {
 }
 
 void MainWindow::onProjectModified(const QString &path) {
+    depGraph.invalidate(path);
+    fileCache.invalidate(path);
+
+    // Files created or deleted in a known directory are patched into the
+    // tree directly. A vanished directory is handled by its parent's event.
+    QString rel = QDir(currentRootDir).relativeFilePath(path);
+    int node = (rel == ".") ? 0 : snapshot.indexOf(rel);
+    if (node >= 0 && snapshot.nodes.at(node).isDir) {
+        if (!QFileInfo(path).isDir() && node > 0) return;
+        if (syncDirectory(path)) return;
+    }
+    // Running as a background service nobody can click Reload, so the
+    // snapshot is refreshed on its own once the burst of changes settles.
+    if (!isVisible() && contextServer->isListening()) {
+        serverRescanTimer->start();
+        return;
+    }
     ui->warningBarWidget->show();
 }
 
@@ -559,7 +1124,14 @@ void MainWindow::updateFileList(QTreeWidgetItem *item) {
 
     if (item->checkState(0) == Qt::Checked) {
         if (ui->selectedListWidget->findItems(relPath, Qt::MatchExactly).isEmpty()) {
-            ui->selectedListWidget->addItem(relPath);
+            QListWidgetItem *listItem = new QListWidgetItem(relPath);
+            if (outlineFiles.contains(relPath)) {
+                QFont font = listItem->font();
+                font.setItalic(true);
+                listItem->setFont(font);
+                listItem->setToolTip("Rendered as outline");
+            }
+            ui->selectedListWidget->addItem(listItem);
         }
     } else {
         auto items = ui->selectedListWidget->findItems(relPath, Qt::MatchExactly);
@@ -567,92 +1139,619 @@ void MainWindow::updateFileList(QTreeWidgetItem *item) {
     }
 }
 
-QString MainWindow::generateAsciiTree(const QString &path, const QString &prefix) {
-    QString res; QDir dir(path);
-    dir.setFilter(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
-    auto list = dir.entryInfoList();
-    for (int i = 0; i < list.size(); ++i) {
-        if (list[i].fileName().startsWith(".")) continue;
-        bool last = (i == list.size() - 1);
-        res += prefix + (last ? "└── " : "├── ") + list[i].fileName() + "\n";
-        if (list[i].isDir()) res += generateAsciiTree(list[i].filePath(), prefix + (last ? "    " : "│   "));
+void MainWindow::onTreeContextMenu(const QPoint &pos) {
+    QTreeWidgetItem *item = ui->treeWidget->itemAt(pos);
+    if (!item) return;
+
+    QMenu menu(this);
+    QAction *actOutline = menu.addAction("Render as Outline");
+    QAction *actFull = menu.addAction("Render in Full");
+    actOutline->setToolTip("Copy signatures and declarations only, with function bodies elided");
+
+    QAction *actRemoveRoot = nullptr;
+    QString itemPath = QDir::cleanPath(item->data(0, Qt::UserRole).toString());
+    if (projectRoots.size() > 1 && projectRoots.contains(itemPath)) {
+        menu.addSeparator();
+        actRemoveRoot = menu.addAction("Remove from Workspace");
     }
-    return res;
-}
 
-QString MainWindow::processFileContent(const QString &filePath) {
-    QFile f(filePath);
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return "";
+    QAction *chosen = menu.exec(ui->treeWidget->viewport()->mapToGlobal(pos));
+    if (chosen && chosen == actRemoveRoot) {
+        QStringList roots = projectRoots;
+        roots.removeOne(itemPath);
+        loadWorkspace(roots);
+        return;
+    }
+    if (chosen == actOutline) setOutlineMode(item, true);
+    else if (chosen == actFull) setOutlineMode(item, false);
+    else return;
 
-    if (filterDataFiles && (filePath.endsWith(".csv", Qt::CaseInsensitive) || filePath.endsWith(".json", Qt::CaseInsensitive))) {
-        QString result;
-        QTextStream in(&f);
-        int lineCount = 0;
-        while (!in.atEnd() && lineCount < maxDataLines) {
-            result += in.readLine() + "\n";
-            lineCount++;
-        }
-        if (!in.atEnd()) {
-            result += QString("\n... [Data truncated by Nafuda: showing first %1 lines only] ...\n").arg(maxDataLines);
-        }
-        return result;
+    refreshOutlineMarks();
+    if (!currentFilePath.isEmpty()) {
+        showPreview(QDir(currentRootDir).relativeFilePath(currentFilePath));
     }
-    return f.readAll();
 }
 
-void MainWindow::copyFullContext() {
-    if (currentRootDir.isEmpty()) return;
-    if (ui->selectedListWidget->count() == 0) {
-        ui->lblStatus->setText("⚠ No files selected for context!");
-        QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+void MainWindow::setOutlineMode(QTreeWidgetItem *item, bool outline) {
+    if (item->childCount() > 0) {
+        for (int i = 0; i < item->childCount(); ++i) setOutlineMode(item->child(i), outline);
         return;
     }
-    QString out = "Project Structure:\n" + QDir(currentRootDir).dirName() + "\n" + generateAsciiTree(currentRootDir, "") + "\n\nFile Contents:\n";
-    for(int i = 0; i < ui->selectedListWidget->count(); ++i) {
-        QString rel = ui->selectedListWidget->item(i)->text();
-        QString fullPath = QDir(currentRootDir).filePath(rel);
-        QFile f(fullPath);
-        if (f.exists()) {
-            QString entry = contentTemplate;
-            entry.replace("{name}", rel).replace("{code}", processFileContent(fullPath));
-            out += entry + "\n";
-        }
+
+    QString fullPath = item->data(0, Qt::UserRole).toString();
+    if (!Outliner::supports(fullPath)) return;
+    QString relPath = QDir(currentRootDir).relativeFilePath(fullPath);
+    if (outline) outlineFiles.insert(relPath);
+    else outlineFiles.remove(relPath);
+
+    QFont font = item->font(0);
+    font.setItalic(outline);
+    item->setFont(0, font);
+}
+
+void MainWindow::refreshOutlineMarks() {
+    for (int i = 0; i < ui->selectedListWidget->count(); ++i) {
+        QListWidgetItem *listItem = ui->selectedListWidget->item(i);
+        bool outline = outlineFiles.contains(listItem->text());
+        QFont font = listItem->font();
+        font.setItalic(outline);
+        listItem->setFont(font);
+        listItem->setToolTip(outline ? "Rendered as outline" : QString());
     }
-    QApplication::clipboard()->setText(out);
-    ui->lblStatus->setText("Full Context Copied!");
-    QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
 }
 
-void MainWindow::copyDirectoryTree() {
-    if (currentRootDir.isEmpty()) return;
-    QApplication::clipboard()->setText(generateAsciiTree(currentRootDir, ""));
-    ui->lblStatus->setText("Directory Tree Copied!");
-    QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+QString MainWindow::rootPrefix(const QString &relPath) const {
+    if (projectRoots.size() < 2) return QString();
+    QDir base(currentRootDir);
+    for (const QString &root : projectRoots) {
+        QString mount = base.relativeFilePath(root);
+        if (relPath == mount || relPath.startsWith(mount + "/")) return mount;
+    }
+    return QString();
 }
 
-void MainWindow::copyFileContent() {
-    if (ui->selectedListWidget->count() == 0) {
-        ui->lblStatus->setText("⚠ No files selected!");
-        QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
-        return;
+QTreeWidgetItem *MainWindow::treeItemFor(const QString &relPath) const {
+    QTreeWidgetItem *item = ui->treeWidget->topLevelItem(0);
+    if (!item || relPath.isEmpty()) return item;
+    // Walk by node names rather than path segments: a workspace root can
+    // span several segments ("libs/core").
+    QStringList chain;
+    for (int n = snapshot.indexOf(relPath); n > 0; n = snapshot.nodes.at(n).parent) {
+        chain.prepend(snapshot.nodes.at(n).name);
     }
-    QString out;
-    for(int i = 0; i < ui->selectedListWidget->count(); ++i) {
-        QString rel = ui->selectedListWidget->item(i)->text();
-        QString fullPath = QDir(currentRootDir).filePath(rel);
-        QFile f(fullPath);
-        if (f.exists()) {
-            QString entry = contentTemplate;
-            entry.replace("{name}", rel).replace("{code}", processFileContent(fullPath));
-            out += entry + "\n";
+    if (chain.isEmpty()) return nullptr;
+    for (const QString &part : chain) {
+        QTreeWidgetItem *next = nullptr;
+        for (int i = 0; i < item->childCount() && !next; ++i) {
+            if (item->child(i)->text(0) == part) next = item->child(i);
         }
+        if (!next) return nullptr;
+        item = next;
     }
-    QApplication::clipboard()->setText(out);
-    ui->lblStatus->setText("Content Copied!");
-    QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+    return item;
 }
 
-void MainWindow::openDataFilterOptions() {
+bool MainWindow::syncDirectory(const QString &dirPath) {
+    Profiler::Scope scope("syncDirectory");
+    QString rel = QDir(currentRootDir).relativeFilePath(dirPath);
+    if (rel == ".") rel.clear();
+    int node = rel.isEmpty() ? 0 : snapshot.indexOf(rel);
+    if (snapshot.isEmpty() || node < 0 || (node == 0 && projectRoots.size() > 1)) return false;
+    QTreeWidgetItem *dirItem = treeItemFor(rel);
+    if (!dirItem) return false;
+
+    QDir dir(dirPath);
+    dir.setFilter(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+    QMap<QString, QFileInfo> onDisk;
+    for (const QFileInfo &info : dir.entryInfoList()) {
+        if (!info.fileName().startsWith(".")) onDisk.insert(info.fileName(), info);
+    }
+
+    bool changed = false;
+    bool needsRescan = false;
+    ui->treeWidget->blockSignals(true);
+
+    QVector<int> removed;
+    QSet<QString> removedNames;
+    for (int child : snapshot.nodes.at(node).children) {
+        const ScanSnapshot::Node &c = snapshot.nodes.at(child);
+        auto disk = onDisk.find(c.name);
+        if (disk != onDisk.end() && disk->isDir() == c.isDir) {
+            onDisk.erase(disk);
+            continue;
+        }
+        removed << child;
+        removedNames.insert(c.name);
+    }
+
+    if (!removed.isEmpty()) {
+        // One pass over the selection and the tree however many went away.
+        const QString prefix = rel.isEmpty() ? QString() : rel + "/";
+        for (int i = ui->selectedListWidget->count() - 1; i >= 0; --i) {
+            QString selected = ui->selectedListWidget->item(i)->text();
+            if (!selected.startsWith(prefix)) continue;
+            if (removedNames.contains(selected.mid(prefix.size()).section('/', 0, 0))) delete ui->selectedListWidget->takeItem(i);
+        }
+        for (int i = dirItem->childCount() - 1; i >= 0; --i) {
+            if (removedNames.contains(dirItem->child(i)->text(0))) delete dirItem->takeChild(i);
+        }
+        depGraph.removeFiles(snapshot.removeNodes(removed));
+        changed = true;
+    }
+
+    for (const QFileInfo &info : onDisk) {
+        // A new directory would need its own guarded walk; leave that to Reload.
+        if (info.isDir()) {
+            needsRescan = true;
+            continue;
+        }
+        int idx = snapshot.addFile(node, info.fileName(), info.size(), info.lastModified().toMSecsSinceEpoch());
+        depGraph.addFile(snapshot.nodes.at(idx).relPath);
+        QTreeWidgetItem *item = new QTreeWidgetItem();
+        item->setText(0, info.fileName());
+        item->setData(0, Qt::UserRole, snapshot.filePath(idx));
+        item->setIcon(0, iconFile);
+        item->setCheckState(0, Qt::Unchecked);
+        dirItem->insertChild(snapshot.nodes.at(node).children.indexOf(idx), item);
+
+        if (profileMatcher.matches(snapshot.nodes.at(idx).relPath, info.size())) {
+            item->setCheckState(0, Qt::Checked);
+            updateFileList(item);
+        }
+        changed = true;
+    }
+    ui->treeWidget->blockSignals(false);
+
+    return changed && !needsRescan;
+}
+
+void MainWindow::applyProfile(const QString &name) {
+    activeProfile = name;
+    profileMatcher = name.isEmpty() ? ProfileMatcher() : ProfileMatcher(profiles.value(name));
+    updateProfileMenu();
+    if (currentRootDir.isEmpty()) return;
+
+    QSettings settings("Nafuda", "Settings");
+    settings.setValue("ProjectProfiles/" + QString::number(FileCache::hashBytes(projectKey().toUtf8()), 16), name);
+    if (!profileMatcher.isActive()) return;
+
+    QSet<QString> wanted;
+    for (const ScanSnapshot::Node &node : snapshot.nodes) {
+        if (!node.isDir && !node.removed && profileMatcher.matches(node.relPath, node.size)) wanted.insert(node.relPath);
+    }
+    const int total = wanted.size();
+
+    // Callers such as refreshProject may already have the tree blocked;
+    // leave it the way it was found.
+    const bool wasUpdating = ui->treeWidget->updatesEnabled();
+    const bool wasBlocked = ui->treeWidget->signalsBlocked();
+    deselectAllFiles();
+    ui->treeWidget->setUpdatesEnabled(false);
+    ui->treeWidget->blockSignals(true);
+    QDir rootDir(currentRootDir);
+    QTreeWidgetItemIterator it(ui->treeWidget);
+    while (*it && !wanted.isEmpty()) {
+        if ((*it)->childCount() == 0) {
+            QString relPath = rootDir.relativeFilePath((*it)->data(0, Qt::UserRole).toString());
+            if (wanted.remove(relPath)) {
+                (*it)->setCheckState(0, Qt::Checked);
+                updateFileList(*it);
+            }
+        }
+        ++it;
+    }
+    ui->treeWidget->blockSignals(wasBlocked);
+    ui->treeWidget->setUpdatesEnabled(wasUpdating);
+
+    ui->lblStatus->setText(QString("Profile '%1': %2 files selected").arg(name).arg(total));
+    QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+}
+
+void MainWindow::applyProfileFromMenu() {
+    QAction *action = qobject_cast<QAction*>(sender());
+    if (action) applyProfile(action->data().toString());
+}
+
+void MainWindow::updateProfileMenu() {
+    ui->menuProfiles->clear();
+
+    QAction *none = ui->menuProfiles->addAction("None");
+    none->setCheckable(true);
+    none->setChecked(activeProfile.isEmpty());
+    connect(none, &QAction::triggered, this, &MainWindow::applyProfileFromMenu);
+
+    if (!profiles.isEmpty()) ui->menuProfiles->addSeparator();
+    for (auto it = profiles.constBegin(); it != profiles.constEnd(); ++it) {
+        QAction *action = ui->menuProfiles->addAction(it.key());
+        action->setData(it.key());
+        action->setCheckable(true);
+        action->setChecked(it.key() == activeProfile);
+        connect(action, &QAction::triggered, this, &MainWindow::applyProfileFromMenu);
+    }
+}
+
+void MainWindow::saveProfiles() {
+    QSettings settings("Nafuda", "Settings");
+    settings.beginGroup("Profiles");
+    settings.remove("");
+    for (auto it = profiles.constBegin(); it != profiles.constEnd(); ++it) {
+        settings.setValue(it.key(), it.value().toVariant());
+    }
+    settings.endGroup();
+}
+
+QString MainWindow::generateAsciiTree(const TreeRenderOptions &options) {
+    return generateAsciiTree(options, options.selectedOnly ? selectedPaths() : QSet<QString>());
+}
+
+QString MainWindow::generateAsciiTree(const TreeRenderOptions &options, const QSet<QString> &selected) {
+    Profiler::Scope scope("generateAsciiTree");
+    return TreeRenderer::render(snapshot, options, selected);
+}
+
+QSet<QString> MainWindow::selectedPaths() const {
+    QSet<QString> paths;
+    for (int i = 0; i < ui->selectedListWidget->count(); ++i) {
+        paths.insert(ui->selectedListWidget->item(i)->text());
+    }
+    return paths;
+}
+
+QString MainWindow::processFileContent(const QString &filePath) {
+    Profiler::Scope scope("processFileContent");
+    if (filterDataFiles && (filePath.endsWith(".csv", Qt::CaseInsensitive) || filePath.endsWith(".json", Qt::CaseInsensitive))) {
+        // Only the first lines are streamed, so a huge data file stays cheap.
+        // Those files are not hashed and never take part in deduplication.
+        fileCache.invalidate(filePath);
+        QFile f(filePath);
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return "";
+        Profiler::instance().addFileProcessed();
+
+        QString result;
+        QTextStream in(&f);
+        int lineCount = 0;
+        while (!in.atEnd() && lineCount < maxDataLines) {
+            result += in.readLine() + "\n";
+            lineCount++;
+        }
+        Profiler::instance().addBytesRead(f.pos());
+        if (!in.atEnd()) {
+            result += QString("\n... [Data truncated by Nafuda: showing first %1 lines only] ...\n").arg(maxDataLines);
+        }
+        return result;
+    }
+
+    // One raw read feeds both the content hash and the text, so line endings
+    // are normalised here rather than by a Text-mode open.
+    QByteArray data;
+    if (!fileCache.read(filePath, &data)) return "";
+    Profiler::instance().addFileProcessed();
+    QString text = QString::fromUtf8(data);
+    text.replace("\r\n", "\n");
+    return text;
+}
+
+void MainWindow::showPreview(const QString &relPath) {
+    highlighter->setFileName(relPath);
+    ui->codeViewer->setPlainText(renderFileContent(relPath));
+}
+
+QString MainWindow::renderFileContent(const QString &relPath, Minifier::Stats *stats) {
+    QString fullPath = QDir(currentRootDir).filePath(relPath);
+    QString code = processFileContent(fullPath);
+    if (gitHunksOnly && gitHunkBase.contains(relPath)) {
+        // Only the changed hunks against the git base, in the file's own words.
+        QString base = QString::fromUtf8(gitRepos[rootPrefix(relPath)].readBlob(gitHunkBase.value(relPath))).replace("\r\n", "\n");
+        QString diff;
+        if (TextDiff::unified(base, code, relPath, &diff, gitHunkContext, 2000) && !diff.isEmpty()) return diff;
+    }
+    if (outlineFiles.contains(relPath)) {
+        code = outliner.cachedOutline(fullPath, code);
+    }
+    if (minifyOutput && Minifier::supports(relPath)) {
+        QString minified = Minifier::minify(relPath, code);
+        if (stats) {
+            stats->bytesBefore += Minifier::utf8Size(code);
+            stats->bytesAfter += Minifier::utf8Size(minified);
+            stats->tokensBefore += Minifier::estimateTokens(code);
+            stats->tokensAfter += Minifier::estimateTokens(minified);
+        }
+        code = minified;
+    }
+    return code;
+}
+
+QStringList MainWindow::orderedSelection() {
+    QStringList files;
+    for (int i = 0; i < ui->selectedListWidget->count(); ++i) {
+        files << ui->selectedListWidget->item(i)->text();
+    }
+    return orderFiles(files);
+}
+
+QStringList MainWindow::orderFiles(QStringList files) {
+    if (!stableOrder) return files;
+
+    // Files that change least go first so an edit only invalidates the tail
+    // of a cached prompt; the path breaks ties so the order never depends on
+    // how the selection was made.
+    QVector<QPair<qint64, QString>> keyed;
+    keyed.reserve(files.size());
+    for (const QString &rel : files) {
+        // A stat, not the scan's mtime: edits inside a directory do not reach
+        // the snapshot, and the point is to move recently edited files last.
+        QDateTime modified = QFileInfo(QDir(currentRootDir).filePath(rel)).lastModified();
+        keyed.append(qMakePair(modified.isValid() ? modified.toMSecsSinceEpoch() : 0, rel));
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    files.clear();
+    for (const auto &k : keyed) files << k.second;
+    return files;
+}
+
+quint64 MainWindow::renderMode(const QString &relPath) const {
+    // Everything besides the file bytes that shapes the rendered text.
+    quint64 mode = 0;
+    if (outlineFiles.contains(relPath)) mode |= 1;
+    if (minifyOutput && Minifier::supports(relPath)) mode |= 2;
+    if (filterDataFiles) mode |= 4 | (quint64(maxDataLines) << 8);
+    if (gitHunksOnly && gitHunkBase.contains(relPath)) {
+        mode |= 8 | (quint64(gitHunkContext) << 40);
+        // Hunks depend on the blob they were taken against, which moves with
+        // HEAD or the base branch even when the file itself does not change.
+        // Modes are only ever compared, so mixing in its hash is enough.
+        mode ^= FileCache::hashBytes(gitHunkBase.value(relPath));
+    }
+    return mode;
+}
+
+QString MainWindow::renderSelectedFiles(QHash<QString, CopyBaseline::Entry> *copied) {
+    return renderFiles(orderedSelection(), contentTemplate, copied);
+}
+
+QString MainWindow::buildFullContext(const QStringList &files, const QString &tmpl, QHash<QString, CopyBaseline::Entry> *copied) {
+    QSet<QString> selected;
+    if (treeOptions.selectedOnly) {
+        for (const QString &rel : files) selected.insert(rel);
+    }
+    QString out = "Project Structure:\n" + QDir(currentRootDir).dirName() + "\n" + generateAsciiTree(treeOptions, selected) + "\n\nFile Contents:\n";
+    out += renderFiles(files, tmpl, copied);
+    return out;
+}
+
+QString MainWindow::renderFiles(const QStringList &files, const QString &tmpl, QHash<QString, CopyBaseline::Entry> *copied) {
+    Profiler::Scope scope("templateExpansion");
+    QString out;
+    minifyStats = Minifier::Stats();
+    dedupCount = 0;
+    dedupBytes = 0;
+    // Keyed on size, content hash and render mode: identical bytes rendered
+    // differently (outlined, minified, as hunks) are not duplicates.
+    QHash<QPair<qint64, QPair<quint64, quint64>>, QString> firstSeen;
+
+    for (const QString &rel : files) {
+        QString fullPath = QDir(currentRootDir).filePath(rel);
+        QFile f(fullPath);
+        if (f.exists()) {
+            QString code;
+            // A still-valid hash lets a duplicate skip the read entirely;
+            // otherwise rendering reads the file once and records its hash.
+            FileCache::Entry cached = fileCache.lookup(fullPath);
+            Minifier::Stats stats;
+            bool rendered = cached.size < 0;
+            if (rendered) {
+                code = renderFileContent(rel, &stats);
+                cached = fileCache.recorded(fullPath);
+            }
+            const quint64 mode = renderMode(rel);
+            QPair<qint64, QPair<quint64, quint64>> key(cached.size, qMakePair(cached.hash, mode));
+            if (cached.size > 0 && firstSeen.contains(key)) {
+                code = QString("[identical to %1]").arg(firstSeen.value(key));
+                dedupCount++;
+                dedupBytes += cached.size;
+                if (copied) copied->insert(rel, copied->value(firstSeen.value(key)));
+            } else {
+                if (cached.size > 0) firstSeen.insert(key, rel);
+                if (!rendered) code = renderFileContent(rel, &stats);
+                minifyStats.bytesBefore += stats.bytesBefore;
+                minifyStats.bytesAfter += stats.bytesAfter;
+                minifyStats.tokensBefore += stats.tokensBefore;
+                minifyStats.tokensAfter += stats.tokensAfter;
+                if (copied) {
+                    CopyBaseline::Entry e;
+                    e.sourceHash = cached.hash;
+                    e.mode = mode;
+                    e.renderHash = FileCache::hashBytes(code.toUtf8());
+                    e.text = code;
+                    copied->insert(rel, e);
+                }
+            }
+            QString entry = tmpl;
+            entry.replace("{name}", rel).replace("{code}", code);
+            out += entry + "\n";
+        }
+    }
+    updateMinifyStatus();
+    return out;
+}
+
+void MainWindow::showCopyResult(const QString &message, const QString &output) {
+    QTimer::singleShot(0, this, &MainWindow::updateDiagnosticsStatus);
+    updatePrefixStatus(output);
+    ui->lblStatus->setText(message);
+    QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+
+    if (dedupCount > 0) {
+        ui->statusbar->showMessage(QString("%1 duplicate file(s) replaced by references, %2 saved")
+                                       .arg(dedupCount)
+                                       .arg(QLocale().formattedDataSize(dedupBytes)), 5000);
+    }
+}
+
+void MainWindow::updatePrefixStatus(const QString &output) {
+    QByteArray current = output.toUtf8();
+    int shared = 0;
+    const int limit = qMin(current.size(), lastCopyOutput.size());
+    while (shared < limit && current.at(shared) == lastCopyOutput.at(shared)) ++shared;
+
+    QString fullHash = QString::number(FileCache::hashBytes(current), 16).rightJustified(16, '0');
+    QString prefixHash = QString::number(FileCache::hashBytes(current.left(shared)), 16).rightJustified(16, '0');
+    QLocale locale;
+
+    if (lastCopyOutput.isEmpty()) {
+        statusPrefixLabel->setText("Hash " + fullHash.left(8));
+    } else if (shared == current.size() && shared == lastCopyOutput.size()) {
+        statusPrefixLabel->setText("Hash " + fullHash.left(8) + " (identical to last copy)");
+    } else {
+        statusPrefixLabel->setText(QString("Prefix %1 (%2% shared)")
+                                       .arg(prefixHash.left(8))
+                                       .arg(current.isEmpty() ? 0 : qint64(shared) * 100 / current.size()));
+    }
+    statusPrefixLabel->setToolTip(QString("Output hash: %1\nShared prefix with previous copy: %2 of %3 bytes\nShared prefix hash: %4")
+                                      .arg(fullHash)
+                                      .arg(locale.toString(shared))
+                                      .arg(locale.toString(current.size()))
+                                      .arg(prefixHash));
+    statusPrefixLabel->show();
+    lastCopyOutput = current;
+}
+
+void MainWindow::copyFullContext() {
+    Profiler::Scope scope("copyFullContext");
+    if (currentRootDir.isEmpty()) return;
+    if (ui->selectedListWidget->count() == 0) {
+        ui->lblStatus->setText("⚠ No files selected for context!");
+        QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+        return;
+    }
+    QHash<QString, CopyBaseline::Entry> copied;
+    QString out = buildFullContext(orderedSelection(), contentTemplate, &copied);
+    {
+        Profiler::Scope clipboardScope("clipboard");
+        QApplication::clipboard()->setText(out);
+    }
+    baseline.replace(copied);
+    baseline.save();
+    showCopyResult("Full Context Copied!", out);
+}
+
+void MainWindow::copyDirectoryTree() {
+    Profiler::Scope scope("copyDirectoryTree");
+    if (currentRootDir.isEmpty()) return;
+    TreeRenderOptions options = treeOptions;
+    options.selectedOnly = false;
+    QString tree = generateAsciiTree(options);
+    {
+        Profiler::Scope clipboardScope("clipboard");
+        QApplication::clipboard()->setText(tree);
+    }
+    ui->lblStatus->setText("Directory Tree Copied!");
+    QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+    QTimer::singleShot(0, this, &MainWindow::updateDiagnosticsStatus);
+}
+
+void MainWindow::copyFileContent() {
+    Profiler::Scope scope("copyFileContent");
+    if (ui->selectedListWidget->count() == 0) {
+        ui->lblStatus->setText("⚠ No files selected!");
+        QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+        return;
+    }
+    QHash<QString, CopyBaseline::Entry> copied;
+    QString out = renderSelectedFiles(&copied);
+    {
+        Profiler::Scope clipboardScope("clipboard");
+        QApplication::clipboard()->setText(out);
+    }
+    baseline.replace(copied);
+    baseline.save();
+    showCopyResult("Content Copied!", out);
+}
+
+void MainWindow::copyDelta() {
+    Profiler::Scope scope("copyDelta");
+    if (currentRootDir.isEmpty()) return;
+    if (baseline.isEmpty()) {
+        copyFileContent();
+        if (ui->selectedListWidget->count() > 0) {
+            ui->lblStatus->setText("No previous copy: copied all selected files");
+        }
+        return;
+    }
+
+    QHash<QString, CopyBaseline::Entry> copied;
+    QStringList added;
+    QStringList modified;
+    QString addedOut;
+    QString modifiedOut;
+    minifyStats = Minifier::Stats();
+    dedupCount = 0;
+    dedupBytes = 0;
+
+    for (const QString &rel : orderedSelection()) {
+        QString fullPath = QDir(currentRootDir).filePath(rel);
+        if (!QFileInfo::exists(fullPath)) continue;
+
+        FileCache::Entry cached = fileCache.lookup(fullPath);
+        CopyBaseline::Entry e;
+        e.sourceHash = cached.hash;
+        e.mode = renderMode(rel);
+
+        // Same bytes rendered the same way: no need to read the file again.
+        const CopyBaseline::Entry *old = baseline.find(rel);
+        if (old && cached.size >= 0 && old->sourceHash == e.sourceHash && old->mode == e.mode) {
+            copied.insert(rel, *old);
+            continue;
+        }
+
+        e.text = renderFileContent(rel, &minifyStats);
+        e.sourceHash = fileCache.recorded(fullPath).hash;
+        e.renderHash = FileCache::hashBytes(e.text.toUtf8());
+        copied.insert(rel, e);
+        if (old && old->renderHash == e.renderHash) continue;
+
+        QString code = e.text;
+        if (old) {
+            modified << rel;
+            QString diff;
+            if (deltaAsDiff && TextDiff::unified(old->text, e.text, rel, &diff)) code = diff;
+        } else {
+            added << rel;
+        }
+        QString entry = contentTemplate;
+        entry.replace("{name}", rel).replace("{code}", code);
+        (old ? modifiedOut : addedOut) += entry + "\n";
+    }
+    updateMinifyStatus();
+
+    QStringList removed;
+    for (const QString &rel : baseline.paths()) {
+        if (!copied.contains(rel)) removed << rel;
+    }
+    std::sort(removed.begin(), removed.end());
+
+    if (added.isEmpty() && modified.isEmpty() && removed.isEmpty()) {
+        ui->lblStatus->setText("No changes since last copy");
+        QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+        return;
+    }
+
+    QString out = QString("Changes since last copy: %1 added, %2 modified, %3 removed\n\n")
+                      .arg(added.size()).arg(modified.size()).arg(removed.size());
+    if (!added.isEmpty()) out += "Added Files:\n" + addedOut + "\n";
+    if (!modified.isEmpty()) out += QString(deltaAsDiff ? "Modified Files (unified diff):\n" : "Modified Files:\n") + modifiedOut + "\n";
+    if (!removed.isEmpty()) out += "Removed Files:\n- " + removed.join("\n- ") + "\n";
+    {
+        Profiler::Scope clipboardScope("clipboard");
+        QApplication::clipboard()->setText(out);
+    }
+    baseline.replace(copied);
+    baseline.save();
+    showCopyResult(QString("Changes Copied! (%1 files)").arg(added.size() + modified.size() + removed.size()), out);
+}
+
+void MainWindow::openDataFilterOptions() {
     QDialog dlg(this);
     dlg.setWindowTitle("Data Filter Settings");
     dlg.resize(320, 120);
@@ -691,8 +1790,472 @@ void MainWindow::openDataFilterOptions() {
         updateFilterStatus();
 
         if (!currentFilePath.isEmpty()) {
-            ui->codeViewer->setText(processFileContent(currentFilePath));
+            showPreview(QDir(currentRootDir).relativeFilePath(currentFilePath));
+        }
+    }
+}
+
+void MainWindow::selectGitChanges() {
+    if (currentRootDir.isEmpty()) return;
+
+    // Every workspace root is its own repository; paths are mapped to and
+    // from the root prefix so the merged result lines up with the tree.
+    gitRepos.clear();
+    GitRepository::Changes changes;
+    QStringList heads;
+    QStringList errors;
+    const QStringList files = snapshot.relativeFiles();
+    for (const QString &root : projectRoots) {
+        const QString mount = rootPrefix(QDir(currentRootDir).relativeFilePath(root));
+        const QString prefix = mount.isEmpty() ? QString() : mount + "/";
+        GitRepository &repo = gitRepos[mount];
+        if (!repo.open(root)) {
+            errors << repo.errorString();
+            gitRepos.remove(mount);
+            continue;
+        }
+
+        QStringList rootFiles;
+        for (const QString &rel : files) {
+            if (rel.startsWith(prefix)) rootFiles << rel.mid(prefix.size());
+        }
+        GitRepository::Changes c = repo.changes(gitOptions, rootFiles);
+        for (const QString &rel : c.modified) changes.modified << prefix + rel;
+        for (const QString &rel : c.staged) changes.staged << prefix + rel;
+        for (const QString &rel : c.untracked) changes.untracked << prefix + rel;
+        for (const QString &rel : c.branch) changes.branch << prefix + rel;
+        for (auto it = c.baseBlobs.constBegin(); it != c.baseBlobs.constEnd(); ++it) {
+            changes.baseBlobs.insert(prefix + it.key(), it.value());
+        }
+        if (!c.baseName.isEmpty()) changes.baseName = c.baseName;
+        QString head = c.headName.isEmpty() ? QString("detached HEAD") : c.headName;
+        heads << (mount.isEmpty() ? head : mount + "@" + head);
+        if (!repo.errorString().isEmpty()) errors << repo.errorString();
+    }
+    if (gitRepos.isEmpty()) {
+        ui->lblStatus->setText("⚠ " + errors.value(0));
+        QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+        return;
+    }
+
+    QSet<QString> wanted;
+    for (const QStringList *list : {&changes.modified, &changes.staged, &changes.untracked, &changes.branch}) {
+        for (const QString &rel : *list) wanted.insert(rel);
+    }
+    gitHunkBase.clear();
+    for (const QString &rel : wanted) {
+        if (changes.baseBlobs.contains(rel)) gitHunkBase.insert(rel, changes.baseBlobs.value(rel));
+    }
+    const int total = wanted.size();
+
+    ui->treeWidget->setUpdatesEnabled(false);
+    ui->treeWidget->blockSignals(true);
+    QDir rootDir(currentRootDir);
+    QTreeWidgetItemIterator it(ui->treeWidget);
+    while (*it && !wanted.isEmpty()) {
+        if ((*it)->childCount() == 0) {
+            QString relPath = rootDir.relativeFilePath((*it)->data(0, Qt::UserRole).toString());
+            if (wanted.remove(relPath)) {
+                (*it)->setCheckState(0, Qt::Checked);
+                updateFileList(*it);
+            }
+        }
+        ++it;
+    }
+    ui->treeWidget->blockSignals(false);
+    ui->treeWidget->setUpdatesEnabled(true);
+
+    QStringList parts;
+    if (gitOptions.modified) parts << QString("%1 modified").arg(changes.modified.size());
+    if (gitOptions.staged) parts << QString("%1 staged").arg(changes.staged.size());
+    if (gitOptions.untracked) parts << QString("%1 untracked").arg(changes.untracked.size());
+    if (gitOptions.branch && !changes.baseName.isEmpty()) parts << QString("%1 vs %2").arg(changes.branch.size()).arg(changes.baseName);
+
+    ui->lblStatus->setText(total == 0 ? "No git changes found" : QString("Selected %1 changed files").arg(total));
+    QTimer::singleShot(3000, [this](){ ui->lblStatus->clear(); });
+    ui->statusbar->showMessage(heads.join(", ") + ": " + parts.join(", ") + (errors.isEmpty() ? QString() : "  (" + errors.join("; ") + ")"), 5000);
+}
+
+void MainWindow::openGitOptions() {
+    QDialog dlg(this);
+    dlg.setWindowTitle("Git Selection Settings");
+    dlg.resize(360, 260);
+    QVBoxLayout *layout = new QVBoxLayout(&dlg);
+
+    layout->addWidget(new QLabel("Select Git Changes ticks:"));
+    QCheckBox *chkModified = new QCheckBox("Modified files (working tree vs index)", &dlg);
+    chkModified->setChecked(gitOptions.modified);
+    layout->addWidget(chkModified);
+    QCheckBox *chkStaged = new QCheckBox("Staged files (index vs HEAD)", &dlg);
+    chkStaged->setChecked(gitOptions.staged);
+    layout->addWidget(chkStaged);
+    QCheckBox *chkUntracked = new QCheckBox("Untracked files (respecting .gitignore)", &dlg);
+    chkUntracked->setChecked(gitOptions.untracked);
+    layout->addWidget(chkUntracked);
+    QCheckBox *chkBranch = new QCheckBox("Files changed on this branch", &dlg);
+    chkBranch->setChecked(gitOptions.branch);
+    layout->addWidget(chkBranch);
+
+    QHBoxLayout *baseLayout = new QHBoxLayout();
+    baseLayout->addWidget(new QLabel("Base branch:"));
+    QLineEdit *editBase = new QLineEdit(gitOptions.baseBranch, &dlg);
+    editBase->setPlaceholderText("auto (origin/HEAD, main, master)");
+    editBase->setEnabled(gitOptions.branch);
+    baseLayout->addWidget(editBase);
+    layout->addLayout(baseLayout);
+    connect(chkBranch, &QCheckBox::toggled, editBase, &QLineEdit::setEnabled);
+
+    QCheckBox *chkHunks = new QCheckBox("Copy only changed hunks of these files", &dlg);
+    chkHunks->setChecked(gitHunksOnly);
+    layout->addWidget(chkHunks);
+
+    QHBoxLayout *contextLayout = new QHBoxLayout();
+    contextLayout->addWidget(new QLabel("Context lines:"));
+    QSpinBox *spinContext = new QSpinBox(&dlg);
+    spinContext->setRange(0, 100);
+    spinContext->setValue(gitHunkContext);
+    spinContext->setEnabled(gitHunksOnly);
+    contextLayout->addWidget(spinContext);
+    layout->addLayout(contextLayout);
+    connect(chkHunks, &QCheckBox::toggled, spinContext, &QSpinBox::setEnabled);
+
+    QDialogButtonBox *btnBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dlg);
+    layout->addStretch();
+    layout->addWidget(btnBox);
+
+    connect(btnBox, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+    connect(btnBox, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+
+    if (dlg.exec() == QDialog::Accepted) {
+        gitOptions.modified = chkModified->isChecked();
+        gitOptions.staged = chkStaged->isChecked();
+        gitOptions.untracked = chkUntracked->isChecked();
+        gitOptions.branch = chkBranch->isChecked();
+        gitOptions.baseBranch = editBase->text().trimmed();
+        gitHunksOnly = chkHunks->isChecked();
+        gitHunkContext = spinContext->value();
+
+        QSettings settings("Nafuda", "Settings");
+        settings.setValue("gitModified", gitOptions.modified);
+        settings.setValue("gitStaged", gitOptions.staged);
+        settings.setValue("gitUntracked", gitOptions.untracked);
+        settings.setValue("gitBranch", gitOptions.branch);
+        settings.setValue("gitBaseBranch", gitOptions.baseBranch);
+        settings.setValue("gitHunksOnly", gitHunksOnly);
+        settings.setValue("gitHunkContext", gitHunkContext);
+
+        if (!currentFilePath.isEmpty()) {
+            showPreview(QDir(currentRootDir).relativeFilePath(currentFilePath));
+        }
+    }
+}
+
+void MainWindow::openProfileOptions() {
+    QDialog dlg(this);
+    dlg.setWindowTitle("Selection Profiles");
+    dlg.resize(480, 560);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(&dlg);
+
+    QHBoxLayout *topLayout = new QHBoxLayout();
+    QComboBox *cmbProfiles = new QComboBox(&dlg);
+    cmbProfiles->addItems(profiles.keys());
+    if (!activeProfile.isEmpty()) cmbProfiles->setCurrentText(activeProfile);
+
+    QToolButton *btnAdd = new QToolButton(&dlg);
+    btnAdd->setText("+");
+    btnAdd->setToolTip("Create New Profile");
+
+    QToolButton *btnRename = new QToolButton(&dlg);
+    btnRename->setText(QString::fromUtf8("\u270E"));
+    btnRename->setToolTip("Rename Profile");
+
+    QToolButton *btnDel = new QToolButton(&dlg);
+    btnDel->setIcon(qApp->style()->standardIcon(QStyle::SP_TrashIcon));
+    btnDel->setToolTip("Delete Selected Profile");
+
+    topLayout->addWidget(new QLabel("Profile:"));
+    topLayout->addWidget(cmbProfiles, 1);
+    topLayout->addWidget(btnAdd);
+    topLayout->addWidget(btnRename);
+    topLayout->addWidget(btnDel);
+    mainLayout->addLayout(topLayout);
+
+    QWidget *fields = new QWidget(&dlg);
+    QVBoxLayout *fieldsLayout = new QVBoxLayout(fields);
+    fieldsLayout->setContentsMargins(0, 0, 0, 0);
+
+    fieldsLayout->addWidget(new QLabel("Include globs (one per line, e.g. src/**/*.cpp):", fields));
+    QPlainTextEdit *editInclude = new QPlainTextEdit(fields);
+    fieldsLayout->addWidget(editInclude);
+
+    fieldsLayout->addWidget(new QLabel("Exclude globs (one per line):", fields));
+    QPlainTextEdit *editExclude = new QPlainTextEdit(fields);
+    fieldsLayout->addWidget(editExclude);
+
+    QHBoxLayout *extLayout = new QHBoxLayout();
+    QLineEdit *editExtensions = new QLineEdit(fields);
+    editExtensions->setPlaceholderText("cpp, h, md");
+    extLayout->addWidget(new QLabel("Extensions:", fields));
+    extLayout->addWidget(editExtensions, 1);
+    fieldsLayout->addLayout(extLayout);
+
+    QHBoxLayout *sizeLayout = new QHBoxLayout();
+    QSpinBox *spinMin = new QSpinBox(fields);
+    spinMin->setRange(0, 10000000);
+    spinMin->setSuffix(" KB");
+    QSpinBox *spinMax = new QSpinBox(fields);
+    spinMax->setRange(0, 10000000);
+    spinMax->setSuffix(" KB");
+    spinMax->setSpecialValueText("No limit");
+    sizeLayout->addWidget(new QLabel("Min size:", fields));
+    sizeLayout->addWidget(spinMin);
+    sizeLayout->addWidget(new QLabel("Max size:", fields));
+    sizeLayout->addWidget(spinMax);
+    fieldsLayout->addLayout(sizeLayout);
+
+    QHBoxLayout *pathsHeader = new QHBoxLayout();
+    QPushButton *btnUseSelection = new QPushButton("Add Current Selection", fields);
+    pathsHeader->addWidget(new QLabel("Always include (one path per line):", fields));
+    pathsHeader->addStretch();
+    pathsHeader->addWidget(btnUseSelection);
+    fieldsLayout->addLayout(pathsHeader);
+    QPlainTextEdit *editPaths = new QPlainTextEdit(fields);
+    fieldsLayout->addWidget(editPaths);
+
+    mainLayout->addWidget(fields, 1);
+
+    QMap<QString, SelectionProfile> tempProfiles = profiles;
+    bool loading = false;
+
+    auto lines = [](QPlainTextEdit *edit) {
+        QStringList out;
+        for (const QString &line : edit->toPlainText().split('\n')) {
+            if (!line.trimmed().isEmpty()) out << line.trimmed();
+        }
+        return out;
+    };
+
+    auto load = [&](const QString &name) {
+        loading = true;
+        const SelectionProfile p = tempProfiles.value(name);
+        editInclude->setPlainText(p.include.join('\n'));
+        editExclude->setPlainText(p.exclude.join('\n'));
+        editExtensions->setText(p.extensions.join(", "));
+        spinMin->setValue(int(p.minSize / 1024));
+        spinMax->setValue(int(p.maxSize / 1024));
+        editPaths->setPlainText(p.paths.join('\n'));
+        fields->setEnabled(!name.isEmpty());
+        loading = false;
+    };
+
+    auto store = [&]() {
+        if (loading || cmbProfiles->currentText().isEmpty()) return;
+        SelectionProfile p;
+        p.include = lines(editInclude);
+        p.exclude = lines(editExclude);
+        for (const QString &ext : editExtensions->text().split(',')) {
+            if (!ext.trimmed().isEmpty()) p.extensions << ext.trimmed();
         }
+        p.minSize = qint64(spinMin->value()) * 1024;
+        p.maxSize = qint64(spinMax->value()) * 1024;
+        p.paths = lines(editPaths);
+        tempProfiles[cmbProfiles->currentText()] = p;
+    };
+
+    load(cmbProfiles->currentText());
+
+    connect(cmbProfiles, &QComboBox::currentTextChanged, [&](const QString &text){ load(text); });
+    connect(editInclude, &QPlainTextEdit::textChanged, [&](){ store(); });
+    connect(editExclude, &QPlainTextEdit::textChanged, [&](){ store(); });
+    connect(editPaths, &QPlainTextEdit::textChanged, [&](){ store(); });
+    connect(editExtensions, &QLineEdit::textChanged, [&](){ store(); });
+    connect(spinMin, QOverload<int>::of(&QSpinBox::valueChanged), [&](){ store(); });
+    connect(spinMax, QOverload<int>::of(&QSpinBox::valueChanged), [&](){ store(); });
+
+    connect(btnUseSelection, &QPushButton::clicked, [&](){
+        QStringList paths = lines(editPaths);
+        for (int i = 0; i < ui->selectedListWidget->count(); ++i) {
+            QString path = ui->selectedListWidget->item(i)->text();
+            if (!paths.contains(path)) paths << path;
+        }
+        editPaths->setPlainText(paths.join('\n'));
+    });
+
+    connect(btnAdd, &QToolButton::clicked, [&](){
+        bool ok;
+        QString text = QInputDialog::getText(&dlg, "New Profile", "Profile Name:", QLineEdit::Normal, "", &ok);
+        if (ok && !text.isEmpty()) {
+            if (tempProfiles.contains(text)) {
+                QMessageBox::warning(&dlg, "Error", "Profile name already exists.");
+                return;
+            }
+            tempProfiles.insert(text, SelectionProfile());
+            cmbProfiles->addItem(text);
+            cmbProfiles->setCurrentText(text);
+        }
+    });
+
+    connect(btnRename, &QToolButton::clicked, [&](){
+        QString currentName = cmbProfiles->currentText();
+        if (currentName.isEmpty()) return;
+        bool ok;
+        QString text = QInputDialog::getText(&dlg, "Rename Profile", "New Name:", QLineEdit::Normal, currentName, &ok);
+        if (ok && !text.isEmpty() && text != currentName) {
+            if (tempProfiles.contains(text)) {
+                QMessageBox::warning(&dlg, "Error", "Profile name already exists.");
+                return;
+            }
+            tempProfiles.insert(text, tempProfiles.take(currentName));
+            cmbProfiles->setItemText(cmbProfiles->currentIndex(), text);
+        }
+    });
+
+    connect(btnDel, &QToolButton::clicked, [&](){
+        QString toRemove = cmbProfiles->currentText();
+        if (toRemove.isEmpty()) return;
+        int ret = QMessageBox::question(&dlg, "Delete Profile", "Delete profile '" + toRemove + "'?", QMessageBox::Yes | QMessageBox::No);
+        if (ret == QMessageBox::Yes) {
+            tempProfiles.remove(toRemove);
+            cmbProfiles->removeItem(cmbProfiles->currentIndex());
+        }
+    });
+
+    QDialogButtonBox *btnBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dlg);
+    mainLayout->addWidget(btnBox);
+    connect(btnBox, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+    connect(btnBox, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+
+    if (dlg.exec() == QDialog::Accepted) {
+        profiles = tempProfiles;
+        saveProfiles();
+
+        // Edits take effect for files appearing from now on; applying the
+        // profile from the menu re-selects the whole tree.
+        if (!profiles.contains(activeProfile)) activeProfile.clear();
+        profileMatcher = activeProfile.isEmpty() ? ProfileMatcher() : ProfileMatcher(profiles.value(activeProfile));
+        updateProfileMenu();
+    }
+}
+
+void MainWindow::openDependencyOptions() {
+    QDialog dlg(this);
+    dlg.setWindowTitle("Dependency Settings");
+    dlg.resize(320, 100);
+    QVBoxLayout *layout = new QVBoxLayout(&dlg);
+
+    QHBoxLayout *spinLayout = new QHBoxLayout();
+    spinLayout->addWidget(new QLabel("Max include/import depth:"));
+    QSpinBox *spinDepth = new QSpinBox(&dlg);
+    spinDepth->setRange(1, 50);
+    spinDepth->setValue(dependencyDepth);
+    spinLayout->addWidget(spinDepth);
+    layout->addLayout(spinLayout);
+
+    QDialogButtonBox *btnBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dlg);
+    layout->addStretch();
+    layout->addWidget(btnBox);
+
+    connect(btnBox, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+    connect(btnBox, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+
+    if (dlg.exec() == QDialog::Accepted) {
+        dependencyDepth = spinDepth->value();
+        QSettings settings("Nafuda", "Settings");
+        settings.setValue("dependencyDepth", dependencyDepth);
+    }
+}
+
+void MainWindow::openTraversalOptions() {
+    QDialog dlg(this);
+    dlg.setWindowTitle("Traversal Settings");
+    dlg.resize(340, 160);
+    QVBoxLayout *layout = new QVBoxLayout(&dlg);
+
+    QCheckBox *chkFollow = new QCheckBox("Follow symbolic links to directories", &dlg);
+    chkFollow->setChecked(traversalPolicy.followSymlinks);
+    layout->addWidget(chkFollow);
+
+    QCheckBox *chkSameFs = new QCheckBox("Stay on the project's filesystem", &dlg);
+    chkSameFs->setChecked(traversalPolicy.sameFilesystem);
+    layout->addWidget(chkSameFs);
+
+    QHBoxLayout *spinLayout = new QHBoxLayout();
+    spinLayout->addWidget(new QLabel("Max directory depth:"));
+    QSpinBox *spinDepth = new QSpinBox(&dlg);
+    spinDepth->setRange(1, 1000);
+    spinDepth->setValue(traversalPolicy.maxDepth);
+    spinLayout->addWidget(spinDepth);
+    layout->addLayout(spinLayout);
+
+    QDialogButtonBox *btnBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dlg);
+    layout->addStretch();
+    layout->addWidget(btnBox);
+
+    connect(btnBox, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+    connect(btnBox, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+
+    if (dlg.exec() == QDialog::Accepted) {
+        traversalPolicy.followSymlinks = chkFollow->isChecked();
+        traversalPolicy.sameFilesystem = chkSameFs->isChecked();
+        traversalPolicy.maxDepth = spinDepth->value();
+
+        QSettings settings("Nafuda", "Settings");
+        settings.setValue("followSymlinks", traversalPolicy.followSymlinks);
+        settings.setValue("sameFilesystem", traversalPolicy.sameFilesystem);
+        settings.setValue("maxTraversalDepth", traversalPolicy.maxDepth);
+
+        refreshProject();
+    }
+}
+
+void MainWindow::openTreeOptions() {
+    QDialog dlg(this);
+    dlg.setWindowTitle("Tree Output Settings");
+    dlg.resize(360, 220);
+    QVBoxLayout *layout = new QVBoxLayout(&dlg);
+
+    auto addSpin = [&](const QString &label, int value, int max) {
+        QHBoxLayout *row = new QHBoxLayout();
+        row->addWidget(new QLabel(label));
+        QSpinBox *spin = new QSpinBox(&dlg);
+        spin->setRange(0, max);
+        spin->setSpecialValueText("Unlimited");
+        spin->setValue(value);
+        row->addWidget(spin);
+        layout->addLayout(row);
+        return spin;
+    };
+
+    QSpinBox *spinLines = addSpin("Max lines:", treeOptions.maxLines, 1000000);
+    QSpinBox *spinTokens = addSpin("Max tokens (approx.):", treeOptions.maxTokens, 10000000);
+    QSpinBox *spinDepth = addSpin("Max depth:", treeOptions.maxDepth, 1000);
+    QSpinBox *spinEntries = addSpin("Max entries per folder:", treeOptions.maxEntriesPerDir, 100000);
+
+    QCheckBox *chkSelected = new QCheckBox("Full context: show selected files and their folders only", &dlg);
+    chkSelected->setChecked(treeOptions.selectedOnly);
+    layout->addWidget(chkSelected);
+
+    QDialogButtonBox *btnBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dlg);
+    layout->addStretch();
+    layout->addWidget(btnBox);
+
+    connect(btnBox, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+    connect(btnBox, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+
+    if (dlg.exec() == QDialog::Accepted) {
+        treeOptions.maxLines = spinLines->value();
+        treeOptions.maxTokens = spinTokens->value();
+        treeOptions.maxDepth = spinDepth->value();
+        treeOptions.maxEntriesPerDir = spinEntries->value();
+        treeOptions.selectedOnly = chkSelected->isChecked();
+
+        QSettings settings("Nafuda", "Settings");
+        settings.setValue("treeMaxLines", treeOptions.maxLines);
+        settings.setValue("treeMaxTokens", treeOptions.maxTokens);
+        settings.setValue("treeMaxDepth", treeOptions.maxDepth);
+        settings.setValue("treeMaxEntriesPerDir", treeOptions.maxEntriesPerDir);
+        settings.setValue("treeSelectedOnly", treeOptions.selectedOnly);
     }
 }
 
@@ -848,6 +2411,10 @@ void MainWindow::showAbout()
 void MainWindow::checkUpdate() {
     QNetworkRequest req(QUrl("https://api.github.com/repos/ahmadardani/nafuda/releases/latest"));
     req.setHeader(QNetworkRequest::UserAgentHeader, "NafudaApp");
+    if (!netManager) {
+        netManager = new QNetworkAccessManager(this);
+        connect(netManager, &QNetworkAccessManager::finished, this, &MainWindow::onUpdateResult);
+    }
     netManager->get(req);
 }
 
@@ -904,7 +2471,7 @@ void MainWindow::refreshProject() {
     ui->treeWidget->setUpdatesEnabled(false);
     ui->treeWidget->blockSignals(true);
 
-    loadProject(currentRootDir);
+    loadWorkspace(projectRoots);
 
     QTreeWidgetItemIterator it(ui->treeWidget);
     while (*it) {
@@ -12,6 +12,21 @@
 #include <QMap>
 #include <QFileSystemWatcher>
 #include <QIcon>
+#include <QToolButton>
+
+#include "dependencygraph.h"
+#include "outliner.h"
+#include "minifier.h"
+#include "filecache.h"
+#include "traversalguard.h"
+#include "scansnapshot.h"
+#include "treerenderer.h"
+#include "copybaseline.h"
+#include "globmatcher.h"
+#include "contextserver.h"
+#include "gitrepository.h"
+#include "selectionprofile.h"
+#include "viewporthighlighter.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -20,27 +35,49 @@ QT_END_NAMESPACE
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
+    friend class NafudaBench;
 
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    bool serveProject(const QString &path, const QString &serverName);
+
+signals:
+    // Emitted once the deferred startup work has finished.
+    void interactive();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
 private slots:
     void openFolder();
+    void addWorkspaceFolder();
     void openTemplateOptions();
     void openDataFilterOptions();
+    void openDependencyOptions();
+    void openTraversalOptions();
+    void openGitOptions();
+    void openProfileOptions();
+    void openTreeOptions();
     void showAbout();
 
     void selectAllFiles();
     void deselectAllFiles();
+    void addDependencies();
+    void selectGitChanges();
+    void applyProfileFromMenu();
 
     void onTreeItemClicked(QTreeWidgetItem *item, int column);
     void onTreeItemChanged(QTreeWidgetItem *item, int column);
     void onCurrentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
+    void onTreeContextMenu(const QPoint &pos);
 
     void copyDirectoryTree();
     void copyFileContent();
     void copyFullContext();
+    void copyDelta();
 
     void checkUpdate();
     void onUpdateResult(QNetworkReply *reply);
@@ -51,11 +88,23 @@ private slots:
 
     void onProjectModified(const QString &path);
     void toggleDarkMode(bool checked);
+    void toggleMinifyOutput(bool checked);
+    void toggleStableOrder(bool checked);
+    void toggleDeltaDiffs(bool checked);
+    void toggleContextServer(bool checked);
+    void toggleDiagnostics(bool checked);
+    void updateDiagnosticsStatus();
+    void showDiagnostics();
     void refreshProject();
+    void finishStartup();
 
 private:
     Ui::MainWindow *ui;
+    bool startupFinished = false;
+    // Base directory that relative paths are taken from: the project root,
+    // or for a workspace the deepest directory containing all of its roots.
     QString currentRootDir;
+    QStringList projectRoots;
     QString contentTemplate;
     const QString defaultTemplate = "File: {name}\n```\n{code}\n```\n";
 
@@ -64,6 +113,9 @@ private:
 
     QLabel *statusPathLabel;
     QLabel *statusFilterLabel;
+    QLabel *statusMinifyLabel;
+    QLabel *statusPrefixLabel;
+    QToolButton *statusDiagButton;
 
     QStringList recentFiles;
     const int maxRecentFiles = 10;
@@ -73,6 +125,7 @@ private:
 
     QFileSystemWatcher *fileWatcher;
     QString currentFilePath;
+    ViewportHighlighter *highlighter;
 
     QIcon iconDir;
     QIcon iconFile;
@@ -80,14 +133,76 @@ private:
     bool filterDataFiles;
     int maxDataLines;
 
-    void populateTree(const QString &path, QTreeWidgetItem *parentItem, QStringList &watchDirs);
+    ScanSnapshot snapshot;
+    TreeRenderOptions treeOptions;
+    DependencyGraph depGraph;
+    int dependencyDepth;
+
+    Outliner outliner;
+    QSet<QString> outlineFiles;
+
+    bool minifyOutput;
+    Minifier::Stats minifyStats;
+
+    TraversalPolicy traversalPolicy;
+
+    FileCache fileCache;
+    int dedupCount;
+    qint64 dedupBytes;
+
+    bool stableOrder;
+    QByteArray lastCopyOutput;
+
+    CopyBaseline baseline;
+    bool deltaAsDiff;
+
+    ContextServer *contextServer;
+    QTimer *serverRescanTimer;
+
+    GitRepository::Options gitOptions;
+    bool gitHunksOnly;
+    int gitHunkContext;
+    QMap<QString, GitRepository> gitRepos;
+    QHash<QString, QByteArray> gitHunkBase;
+
+    QMap<QString, SelectionProfile> profiles;
+    QString activeProfile;
+    ProfileMatcher profileMatcher;
+
+    void populateTree(int node, QTreeWidgetItem *parentItem);
+    QTreeWidgetItem *treeItemFor(const QString &relPath) const;
+    bool syncDirectory(const QString &dirPath);
+    void applyProfile(const QString &name);
+    void updateProfileMenu();
+    void saveProfiles();
     void setAllChildCheckState(QTreeWidgetItem *item, Qt::CheckState state);
     void updateFileList(QTreeWidgetItem *item);
-    QString generateAsciiTree(const QString &path, const QString &prefix);
+    QString generateAsciiTree(const TreeRenderOptions &options);
+    QString generateAsciiTree(const TreeRenderOptions &options, const QSet<QString> &selected);
+    QSet<QString> selectedPaths() const;
     QString processFileContent(const QString &filePath);
+    QString renderFileContent(const QString &relPath, Minifier::Stats *stats = nullptr);
+    void showPreview(const QString &relPath);
+    QStringList orderFiles(QStringList files);
+    QStringList orderedSelection();
+    quint64 renderMode(const QString &relPath) const;
+    QString renderFiles(const QStringList &files, const QString &tmpl, QHash<QString, CopyBaseline::Entry> *copied = nullptr);
+    QString renderSelectedFiles(QHash<QString, CopyBaseline::Entry> *copied = nullptr);
+    QString buildFullContext(const QStringList &files, const QString &tmpl, QHash<QString, CopyBaseline::Entry> *copied = nullptr);
+    void setOutlineMode(QTreeWidgetItem *item, bool outline);
+    void refreshOutlineMarks();
     void updateFilterStatus();
-
-    void loadProject(const QString &path);
+    void updateMinifyStatus();
+    void showCopyResult(const QString &message, const QString &output);
+    void updatePrefixStatus(const QString &output);
+
+    void applyTheme(bool dark);
+    void loadProject(const QString &path, bool remember = true);
+    void loadWorkspace(QStringList roots, bool remember = true);
+    QString projectKey() const { return projectRoots.join('\n'); }
+    QString rootPrefix(const QString &relPath) const;
+    bool startContextServer(const QString &name);
+    QJsonObject handleServerRequest(const QJsonObject &request);
     void addToRecent(const QString &path);
     void updateRecentMenu();
     QString getRelativeTime(const QDateTime &dt);
@@ -0,0 +1,295 @@
+#include "minifier.h"
+
+#include <QFileInfo>
+#include <QSet>
+
+namespace {
+
+enum Syntax { None, CLike, Cpp, JavaScript, Go, Rust, Css, Python };
+
+Syntax syntaxFor(const QString &fileName) {
+    static const QSet<QString> cExts = {"c", "h", "java"};
+    static const QSet<QString> cppExts = {"cc", "cpp", "cxx", "hpp", "hh", "hxx", "ipp", "inl"};
+    static const QSet<QString> jsExts = {"js", "jsx", "mjs", "cjs", "ts", "tsx", "mts", "cts"};
+
+    QString ext = QFileInfo(fileName).suffix().toLower();
+    if (cExts.contains(ext)) return CLike;
+    if (cppExts.contains(ext)) return Cpp;
+    if (jsExts.contains(ext)) return JavaScript;
+    if (ext == "go") return Go;
+    if (ext == "rs") return Rust;
+    if (ext == "css") return Css;
+    if (ext == "py" || ext == "pyi") return Python;
+    return None;
+}
+
+inline bool isIdent(QChar c) {
+    return c.isLetterOrNumber() || c == '_' || c == '$';
+}
+
+// Smallest space indent used in the file, or 0 when indentation should be left
+// alone (tab-indented files, or indents already at two spaces or less).
+int indentUnit(const QChar *s, int n) {
+    int unit = 0;
+    bool lineStart = true;
+    int width = 0;
+    for (int i = 0; i < n; ++i) {
+        QChar c = s[i];
+        if (lineStart) {
+            if (c == ' ') { ++width; continue; }
+            if (c == '\t') return 0;
+            if (c != '\n' && c != '\r' && width > 0 && (unit == 0 || width < unit)) unit = width;
+            lineStart = false;
+        }
+        if (c == '\n') {
+            lineStart = true;
+            width = 0;
+        }
+    }
+    return unit > 2 ? unit : 0;
+}
+
+// End of a quoted literal opened at i. Unterminated literals end at the line
+// break unless the language allows them to span lines.
+int quotedEnd(const QChar *s, int n, int i, QChar quote, bool multiline) {
+    for (int j = i + 1; j < n; ++j) {
+        QChar c = s[j];
+        if (c == '\\') { ++j; continue; }
+        if (c == quote) return j + 1;
+        if (c == '\n' && !multiline) return j;
+    }
+    return n;
+}
+
+int find(const QChar *s, int n, int from, const QString &needle) {
+    const int m = needle.size();
+    for (int j = from; j + m <= n; ++j) {
+        if (s[j] == needle.at(0) && QString::fromRawData(s + j, m) == needle) return j;
+    }
+    return -1;
+}
+
+}
+
+bool Minifier::supports(const QString &fileName) {
+    return syntaxFor(fileName) != None;
+}
+
+QString Minifier::minify(const QString &fileName, const QString &content) {
+    const Syntax syntax = syntaxFor(fileName);
+    if (syntax == None) return content;
+
+    const QChar *s = content.constData();
+    const int n = content.size();
+    const int unit = indentUnit(s, n);
+    const bool lineComments = (syntax != Css && syntax != Python);
+    const bool blockComments = (syntax != Python);
+
+    QString out;
+    out.reserve(n);
+    QString line;
+    bool commentOnly = false;
+    bool pendingBlank = false;
+    QChar lastSig;
+
+    auto flush = [&]() {
+        int end = line.size();
+        while (end > 0 && (line.at(end - 1) == ' ' || line.at(end - 1) == '\t' || line.at(end - 1) == '\r')) --end;
+        line.truncate(end);
+
+        if (line.isEmpty()) {
+            if (!commentOnly && !out.isEmpty()) pendingBlank = true;
+        } else {
+            if (pendingBlank) {
+                out += '\n';
+                pendingBlank = false;
+            }
+            if (unit > 0) {
+                int width = 0;
+                while (width < line.size() && line.at(width) == ' ') ++width;
+                if (width > 0) line.replace(0, width, QString((width / unit) * 2 + width % unit, ' '));
+            }
+            out += line;
+            out += '\n';
+        }
+        line.clear();
+        commentOnly = false;
+    };
+
+    auto isSpecial = [&](QChar c) {
+        switch (c.unicode()) {
+        case '\n': case '"': case '\'': case '/':
+            return true;
+        case '`':
+            return syntax == JavaScript || syntax == Go;
+        case '#':
+            return syntax == Python;
+        case 'r':
+            return syntax == Rust;
+        default:
+            return false;
+        }
+    };
+
+    auto appendCode = [&](int from, int to) {
+        line.append(s + from, to - from);
+        for (int k = to - 1; k >= from; --k) {
+            if (!s[k].isSpace()) {
+                lastSig = s[k];
+                break;
+            }
+        }
+    };
+
+    int i = 0;
+    while (i < n) {
+        QChar c = s[i];
+        QChar next = (i + 1 < n) ? s[i + 1] : QChar();
+
+        if (!isSpecial(c)) {
+            int j = i + 1;
+            while (j < n && !isSpecial(s[j])) ++j;
+            appendCode(i, j);
+            i = j;
+            continue;
+        }
+
+        if (c == '\n') {
+            flush();
+            ++i;
+            continue;
+        }
+
+        if (c == '/' && next == '/' && lineComments) {
+            while (i < n && s[i] != '\n') ++i;
+            commentOnly = true;
+            continue;
+        }
+        if (c == '/' && next == '*' && blockComments) {
+            int end = find(s, n, i + 2, "*/");
+            i = (end < 0) ? n : end + 2;
+            if (!line.isEmpty() && !line.at(line.size() - 1).isSpace()) line += ' ';
+            commentOnly = true;
+            continue;
+        }
+        if (c == '#' && syntax == Python) {
+            while (i < n && s[i] != '\n') ++i;
+            commentOnly = true;
+            continue;
+        }
+
+        if (c == '/' && syntax == JavaScript && (lastSig.isNull() || QStringLiteral("(,=:[!&|?{};+-*%<>~^").contains(lastSig))) {
+            // Regex literal: scanned so that slashes inside it are not taken for comments.
+            bool inClass = false;
+            int end = -1;
+            for (int j = i + 1; j < n && s[j] != '\n'; ++j) {
+                if (s[j] == '\\') { ++j; continue; }
+                if (s[j] == '[') inClass = true;
+                else if (s[j] == ']') inClass = false;
+                else if (s[j] == '/' && !inClass) { end = j + 1; break; }
+            }
+            if (end > 0) {
+                appendCode(i, end);
+                i = end;
+                continue;
+            }
+        }
+
+        if (c == '"' || c == '\'' || c == '`') {
+            int end;
+            if (syntax == Python && i + 2 < n && next == c && s[i + 2] == c) {
+                int close = find(s, n, i + 3, QString(3, c));
+                end = (close < 0) ? n : close + 3;
+            } else if (c == '"' && syntax == Cpp && i > 0 && s[i - 1] == 'R') {
+                int paren = -1;
+                for (int j = i + 1; j < n && j - i <= 17; ++j) {
+                    if (s[j] == '(') { paren = j; break; }
+                }
+                if (paren > 0) {
+                    QString terminator = ")" + QString(s + i + 1, paren - i - 1) + "\"";
+                    int close = find(s, n, paren, terminator);
+                    end = (close < 0) ? n : close + terminator.size();
+                } else {
+                    end = quotedEnd(s, n, i, c, false);
+                }
+            } else if (c == '`' && syntax == Go) {
+                int close = find(s, n, i + 1, "`");
+                end = (close < 0) ? n : close + 1;
+            } else if (c == '`') {
+                end = quotedEnd(s, n, i, c, true);
+            } else if (c == '\'' && syntax != JavaScript && syntax != Python && syntax != Css) {
+                // Character literal; anything else (Rust lifetimes, digit separators) is plain text.
+                end = -1;
+                if (next == '\\') {
+                    // i + 2 is the escaped character itself, which may be a quote.
+                    for (int j = i + 3; j < n && j - i <= 12; ++j) {
+                        if (s[j] == '\'') { end = j + 1; break; }
+                    }
+                } else if (i + 2 < n && s[i + 2] == '\'') {
+                    end = i + 3;
+                }
+                if (end < 0) {
+                    appendCode(i, i + 1);
+                    ++i;
+                    continue;
+                }
+            } else {
+                end = quotedEnd(s, n, i, c, false);
+            }
+            appendCode(i, end);
+            i = end;
+            continue;
+        }
+
+        if (c == 'r' && syntax == Rust && (i == 0 || !isIdent(s[i - 1]) || (s[i - 1] == 'b' && (i < 2 || !isIdent(s[i - 2]))))) {
+            int j = i + 1;
+            while (j < n && s[j] == '#') ++j;
+            if (j < n && s[j] == '"') {
+                QString terminator = "\"" + QString(j - i - 1, '#');
+                int close = find(s, n, j + 1, terminator);
+                int end = (close < 0) ? n : close + terminator.size();
+                appendCode(i, end);
+                i = end;
+                continue;
+            }
+        }
+
+        appendCode(i, i + 1);
+        ++i;
+    }
+
+    if (!line.isEmpty()) flush();
+    if (!content.endsWith('\n') && out.endsWith('\n')) out.chop(1);
+    return out;
+}
+
+qint64 Minifier::estimateTokens(const QString &text) {
+    // Rough BPE-style estimate: a word costs one token per four characters,
+    // every other visible character costs one, whitespace is folded in.
+    qint64 tokens = 0;
+    const QChar *s = text.constData();
+    const int n = text.size();
+    int i = 0;
+    while (i < n) {
+        if (s[i].isLetterOrNumber() || s[i] == '_') {
+            int start = i;
+            while (i < n && (s[i].isLetterOrNumber() || s[i] == '_')) ++i;
+            tokens += (i - start + 3) / 4;
+        } else {
+            if (!s[i].isSpace()) ++tokens;
+            ++i;
+        }
+    }
+    return tokens;
+}
+
+qint64 Minifier::utf8Size(const QString &text) {
+    qint64 bytes = 0;
+    for (QChar c : text) {
+        ushort u = c.unicode();
+        if (u < 0x80) bytes += 1;
+        else if (u < 0x800 || c.isSurrogate()) bytes += 2;
+        else bytes += 3;
+    }
+    return bytes;
+}
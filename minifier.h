@@ -0,0 +1,26 @@
+#ifndef MINIFIER_H
+#define MINIFIER_H
+
+#include <QString>
+
+// Language-aware size reduction for copied context: strips comments (and with
+// them license headers), drops trailing whitespace, collapses blank-line runs
+// and narrows space indentation. String, character, raw-string and regex
+// literals are always copied verbatim.
+class Minifier
+{
+public:
+    struct Stats {
+        qint64 bytesBefore = 0;
+        qint64 bytesAfter = 0;
+        qint64 tokensBefore = 0;
+        qint64 tokensAfter = 0;
+    };
+
+    static bool supports(const QString &fileName);
+    static QString minify(const QString &fileName, const QString &content);
+    static qint64 estimateTokens(const QString &text);
+    static qint64 utf8Size(const QString &text);
+};
+
+#endif
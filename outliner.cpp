@@ -0,0 +1,316 @@
+#include "outliner.h"
+#include "profiler.h"
+
+#include <QFileInfo>
+#include <QStringList>
+#include <QSet>
+
+namespace {
+
+struct LexMode {
+    bool cFamily;
+    bool singleQuoteStrings;
+    bool backtickStrings;
+};
+
+bool isWordChar(QChar c) {
+    return c.isLetterOrNumber() || c == '_';
+}
+
+// Returns the end of the string, character literal or comment starting at i,
+// or -1 when s[i] does not open one. isComment tells the two apart.
+int literalEnd(const QString &s, int i, const LexMode &mode, bool &isComment) {
+    const int n = s.size();
+    QChar c = s.at(i);
+    QChar next = (i + 1 < n) ? s.at(i + 1) : QChar();
+    isComment = false;
+
+    if (c == '/' && next == '/') {
+        isComment = true;
+        int end = s.indexOf('\n', i);
+        return end < 0 ? n : end;
+    }
+    if (c == '/' && next == '*') {
+        isComment = true;
+        int end = s.indexOf("*/", i + 2);
+        return end < 0 ? n : end + 2;
+    }
+    if (c == '"') {
+        if (mode.cFamily && i > 0 && s.at(i - 1) == 'R') {
+            int paren = s.indexOf('(', i + 1);
+            if (paren > 0 && paren - i <= 17) {
+                QString terminator = ")" + s.mid(i + 1, paren - i - 1) + "\"";
+                int end = s.indexOf(terminator, paren);
+                return end < 0 ? n : end + terminator.size();
+            }
+        }
+        for (int j = i + 1; j < n; ++j) {
+            if (s.at(j) == '\\') { ++j; continue; }
+            if (s.at(j) == '"' || s.at(j) == '\n') return j + 1;
+        }
+        return n;
+    }
+    if (c == '`' && mode.backtickStrings) {
+        for (int j = i + 1; j < n; ++j) {
+            if (s.at(j) == '\\') { ++j; continue; }
+            if (s.at(j) == '`') return j + 1;
+        }
+        return n;
+    }
+    if (c == '\'') {
+        if (mode.singleQuoteStrings) {
+            for (int j = i + 1; j < n; ++j) {
+                if (s.at(j) == '\\') { ++j; continue; }
+                if (s.at(j) == '\'' || s.at(j) == '\n') return j + 1;
+            }
+            return n;
+        }
+        // Character literal; anything else (Rust lifetimes, digit separators) is plain text.
+        if (next == '\\') {
+            int end = s.indexOf('\'', i + 3);
+            if (end > 0 && end - i <= 12) return end + 1;
+            return -1;
+        }
+        if (i + 2 < n && s.at(i + 2) == '\'') return i + 3;
+    }
+    return -1;
+}
+
+int matchingBrace(const QString &s, int open, const LexMode &mode) {
+    int depth = 0;
+    bool isComment;
+    for (int i = open; i < s.size(); ++i) {
+        int end = literalEnd(s, i, mode, isComment);
+        if (end >= 0) {
+            i = end - 1;
+            continue;
+        }
+        if (s.at(i) == '{') ++depth;
+        else if (s.at(i) == '}' && --depth == 0) return i;
+    }
+    return s.size() - 1;
+}
+
+// A brace opens a container (its members are kept) when the declaration in
+// front of it is a type, namespace, module or impl block. Generic argument
+// lists, parameter lists and initializers are ignored for the keyword check.
+bool opensContainer(const QString &header) {
+    QString reduced;
+    int angle = 0;
+    for (QChar c : header) {
+        // Inside a template list these start default arguments, not the body.
+        if ((c == '(' || c == '=') && angle == 0) break;
+        if (c == '<') { ++angle; continue; }
+        if (c == '>' && angle > 0) { --angle; continue; }
+        if (angle == 0) reduced += c;
+    }
+
+    static const QSet<QString> keywords = {
+        "class", "struct", "union", "enum", "namespace", "interface",
+        "impl", "trait", "mod", "extern", "record"
+    };
+    int i = 0;
+    while (i < reduced.size()) {
+        if (!isWordChar(reduced.at(i))) { ++i; continue; }
+        int start = i;
+        while (i < reduced.size() && isWordChar(reduced.at(i))) ++i;
+        if (keywords.contains(reduced.mid(start, i - start))) return true;
+    }
+    return false;
+}
+
+int indentOf(const QString &line) {
+    int i = 0;
+    while (i < line.size() && (line.at(i) == ' ' || line.at(i) == '\t')) ++i;
+    return i;
+}
+
+}
+
+bool Outliner::supports(const QString &fileName) {
+    static const QSet<QString> exts = {
+        "c", "h", "cc", "cpp", "cxx", "hpp", "hh", "hxx", "ipp", "inl",
+        "java", "go", "rs", "js", "jsx", "mjs", "cjs", "ts", "tsx", "mts", "cts",
+        "py", "pyi"
+    };
+    return exts.contains(QFileInfo(fileName).suffix().toLower());
+}
+
+QString Outliner::outline(const QString &fileName, const QString &content) {
+    QString ext = QFileInfo(fileName).suffix().toLower();
+    if (ext == "py" || ext == "pyi") return outlinePython(content);
+
+    static const QSet<QString> cExts = {"c", "h", "cc", "cpp", "cxx", "hpp", "hh", "hxx", "ipp", "inl"};
+    static const QSet<QString> jsExts = {"js", "jsx", "mjs", "cjs", "ts", "tsx", "mts", "cts"};
+    if (cExts.contains(ext)) return outlineBraces(content, true, false, false);
+    if (jsExts.contains(ext)) return outlineBraces(content, false, true, true);
+    if (ext == "go") return outlineBraces(content, false, false, true);
+    if (ext == "java" || ext == "rs") return outlineBraces(content, false, false, false);
+    return content;
+}
+
+QString Outliner::cachedOutline(const QString &filePath, const QString &content) {
+    QFileInfo info(filePath);
+    auto it = cache.constFind(filePath);
+    if (it != cache.constEnd() && it->modified == info.lastModified() && it->size == info.size()) {
+        Profiler::instance().addCacheHit();
+        return it->text;
+    }
+    Profiler::instance().addCacheMiss();
+    Entry entry{info.lastModified(), info.size(), outline(filePath, content)};
+    cache.insert(filePath, entry);
+    return entry.text;
+}
+
+void Outliner::clear() {
+    cache.clear();
+}
+
+QString Outliner::outlineBraces(const QString &src, bool cFamily, bool singleQuoteStrings, bool backtickStrings) {
+    const LexMode mode{cFamily, singleQuoteStrings, backtickStrings};
+    const int n = src.size();
+    QString out;
+    out.reserve(n / 2);
+    QString header;
+    bool lineStart = true;
+    bool isComment;
+
+    int i = 0;
+    while (i < n) {
+        QChar c = src.at(i);
+
+        if (cFamily && lineStart && c == '#') {
+            int end = i;
+            while (true) {
+                end = src.indexOf('\n', end);
+                if (end < 0) { end = n; break; }
+                int back = end - 1;
+                if (back >= 0 && src.at(back) == '\r') --back;
+                if (back >= i && src.at(back) == '\\') { ++end; continue; }
+                break;
+            }
+            out += src.mid(i, end - i);
+            header.clear();
+            i = end;
+            continue;
+        }
+
+        int end = literalEnd(src, i, mode, isComment);
+        if (end >= 0) {
+            out += src.mid(i, end - i);
+            if (!isComment) header += "\"\"";
+            lineStart = false;
+            i = end;
+            continue;
+        }
+
+        if (c == '{') {
+            if (opensContainer(header)) {
+                out += c;
+                ++i;
+            } else {
+                out += "{ ... }";
+                i = matchingBrace(src, i, mode) + 1;
+            }
+            header.clear();
+            lineStart = false;
+            continue;
+        }
+
+        out += c;
+        if (c == ';' || c == '}') header.clear();
+        else header += c;
+
+        if (c == '\n') lineStart = true;
+        else if (!c.isSpace()) lineStart = false;
+        ++i;
+    }
+    return out;
+}
+
+QString Outliner::outlinePython(const QString &src) {
+    const QStringList lines = src.split('\n');
+    QStringList out;
+    int skipIndent = -1;
+
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString &line = lines.at(i);
+        QString stripped = line.trimmed();
+        int indent = indentOf(line);
+
+        if (skipIndent >= 0) {
+            if (stripped.isEmpty() || indent > skipIndent) continue;
+            skipIndent = -1;
+        }
+
+        if (!stripped.startsWith("def ") && !stripped.startsWith("async def ")) {
+            out << line;
+            continue;
+        }
+
+        // The signature ends at the first colon outside brackets and strings.
+        int colonLine = -1;
+        int colonPos = -1;
+        int depth = 0;
+        for (int j = i; j < lines.size() && colonLine < 0; ++j) {
+            const QString &l = lines.at(j);
+            QChar quote;
+            for (int k = 0; k < l.size(); ++k) {
+                QChar c = l.at(k);
+                if (!quote.isNull()) {
+                    if (c == '\\') ++k;
+                    else if (c == quote) quote = QChar();
+                    continue;
+                }
+                if (c == '"' || c == '\'') quote = c;
+                else if (c == '#') break;
+                else if (c == '(' || c == '[' || c == '{') ++depth;
+                else if (c == ')' || c == ']' || c == '}') --depth;
+                else if (c == ':' && depth == 0) {
+                    colonLine = j;
+                    colonPos = k;
+                    break;
+                }
+            }
+        }
+        if (colonLine < 0) {
+            out << line;
+            continue;
+        }
+
+        for (int k = i; k < colonLine; ++k) out << lines.at(k);
+        const QString &last = lines.at(colonLine);
+        QString rest = last.mid(colonPos + 1).trimmed();
+        if (!rest.isEmpty() && !rest.startsWith('#')) {
+            out << last.left(colonPos + 1) + " ...";
+            i = colonLine;
+            continue;
+        }
+        out << last;
+        i = colonLine;
+
+        int body = colonLine + 1;
+        while (body < lines.size() && lines.at(body).trimmed().isEmpty()) ++body;
+        QString bodyIndent = line.left(indent) + "    ";
+        if (body < lines.size() && indentOf(lines.at(body)) > indent) {
+            bodyIndent = lines.at(body).left(indentOf(lines.at(body)));
+
+            QString first = lines.at(body).trimmed();
+            int prefix = 0;
+            while (prefix < first.size() && prefix < 2 && first.at(prefix).isLetter()) ++prefix;
+            QString quote = first.mid(prefix, 3);
+            if (quote == "\"\"\"" || quote == "'''") {
+                int close = body;
+                if (first.indexOf(quote, prefix + 3) < 0) {
+                    close = body + 1;
+                    while (close < lines.size() && !lines.at(close).contains(quote)) ++close;
+                }
+                for (int k = body; k <= close && k < lines.size(); ++k) out << lines.at(k);
+                i = close;
+            }
+        }
+        out << bodyIndent + "...";
+        skipIndent = indent;
+    }
+    return out.join('\n');
+}
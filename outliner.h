@@ -0,0 +1,32 @@
+#ifndef OUTLINER_H
+#define OUTLINER_H
+
+#include <QString>
+#include <QDateTime>
+#include <QHash>
+
+// Reduces source files to their skeleton: declarations, signatures, class and
+// struct members and comments are kept, function bodies become placeholders.
+// The lexer is tolerant by design; anything it does not understand is copied.
+class Outliner
+{
+public:
+    static bool supports(const QString &fileName);
+    static QString outline(const QString &fileName, const QString &content);
+
+    QString cachedOutline(const QString &filePath, const QString &content);
+    void clear();
+
+private:
+    struct Entry {
+        QDateTime modified;
+        qint64 size;
+        QString text;
+    };
+    QHash<QString, Entry> cache;
+
+    static QString outlineBraces(const QString &src, bool cFamily, bool singleQuoteStrings, bool backtickStrings);
+    static QString outlinePython(const QString &src);
+};
+
+#endif
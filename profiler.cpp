@@ -0,0 +1,185 @@
+#include "profiler.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+static Profiler::Counters diff(const Profiler::Counters &a, const Profiler::Counters &b) {
+    Profiler::Counters d;
+    d.bytesRead = a.bytesRead - b.bytesRead;
+    d.filesProcessed = a.filesProcessed - b.filesProcessed;
+    d.cacheHits = a.cacheHits - b.cacheHits;
+    d.cacheMisses = a.cacheMisses - b.cacheMisses;
+    return d;
+}
+
+static QJsonObject countersToJson(const Profiler::Counters &c) {
+    QJsonObject obj;
+    obj["bytes_read"] = double(c.bytesRead);
+    obj["files_processed"] = double(c.filesProcessed);
+    obj["cache_hits"] = double(c.cacheHits);
+    obj["cache_misses"] = double(c.cacheMisses);
+    return obj;
+}
+
+Profiler::Scope::Scope(const char *name)
+    : name(name), start(0)
+{
+    if (!name) return;
+    Profiler &p = Profiler::instance();
+    before = p.snapshot();
+    start = p.clock.nsecsElapsed();
+}
+
+Profiler::Scope::~Scope() {
+    if (!name) return;
+    Profiler &p = Profiler::instance();
+    p.record(name, start, p.clock.nsecsElapsed(), before);
+}
+
+Profiler::Profiler()
+    : nextSpan(0)
+{
+    clock.start();
+    spans.reserve(maxSpans);
+}
+
+Profiler &Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Counters Profiler::snapshot() const {
+    QMutexLocker lock(&mutex);
+    return counters;
+}
+
+void Profiler::addBytesRead(qint64 bytes) {
+    QMutexLocker lock(&mutex);
+    counters.bytesRead += bytes;
+}
+
+void Profiler::addFileProcessed() {
+    QMutexLocker lock(&mutex);
+    counters.filesProcessed++;
+}
+
+void Profiler::addCacheHit() {
+    QMutexLocker lock(&mutex);
+    counters.cacheHits++;
+}
+
+void Profiler::addCacheMiss() {
+    QMutexLocker lock(&mutex);
+    counters.cacheMisses++;
+}
+
+void Profiler::record(const char *name, qint64 start, qint64 end, const Counters &before) {
+    QMutexLocker lock(&mutex);
+    Counters delta = diff(counters, before);
+    qint64 duration = end - start;
+
+    StageStats &s = stageStats[QString::fromLatin1(name)];
+    s.calls++;
+    s.totalNs += duration;
+    s.lastNs = duration;
+    s.maxNs = qMax(s.maxNs, duration);
+    s.last = delta;
+    s.total.bytesRead += delta.bytesRead;
+    s.total.filesProcessed += delta.filesProcessed;
+    s.total.cacheHits += delta.cacheHits;
+    s.total.cacheMisses += delta.cacheMisses;
+    last = QString::fromLatin1(name);
+
+    Span span{name, start, duration, delta};
+    if (spans.size() < maxSpans) spans.append(span);
+    else spans[nextSpan] = span;
+    nextSpan = (nextSpan + 1) % maxSpans;
+}
+
+QMap<QString, Profiler::StageStats> Profiler::stages() const {
+    QMutexLocker lock(&mutex);
+    return stageStats;
+}
+
+QString Profiler::lastStage() const {
+    QMutexLocker lock(&mutex);
+    return last;
+}
+
+QByteArray Profiler::toJson() const {
+    QMutexLocker lock(&mutex);
+    QJsonArray stageArray;
+    for (auto it = stageStats.constBegin(); it != stageStats.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["stage"] = it.key();
+        obj["calls"] = double(it->calls);
+        obj["total_ms"] = it->totalNs / 1e6;
+        obj["last_ms"] = it->lastNs / 1e6;
+        obj["max_ms"] = it->maxNs / 1e6;
+        obj["last"] = countersToJson(it->last);
+        obj["total"] = countersToJson(it->total);
+        stageArray.append(obj);
+    }
+    QJsonObject root;
+    root["stages"] = stageArray;
+    root["counters"] = countersToJson(counters);
+    return QJsonDocument(root).toJson();
+}
+
+QByteArray Profiler::toChromeTrace() const {
+    // Chrome trace event format: complete ("X") events in microseconds,
+    // loadable in chrome://tracing or Perfetto.
+    QMutexLocker lock(&mutex);
+    QJsonArray events;
+    int count = spans.size();
+    int first = (count < maxSpans) ? 0 : nextSpan;
+    for (int i = 0; i < count; ++i) {
+        const Span &span = spans.at((first + i) % count);
+        QJsonObject ev;
+        ev["name"] = QString::fromLatin1(span.name);
+        ev["cat"] = "nafuda";
+        ev["ph"] = "X";
+        ev["ts"] = span.startNs / 1000.0;
+        ev["dur"] = span.durationNs / 1000.0;
+        ev["pid"] = 1;
+        ev["tid"] = 1;
+        ev["args"] = countersToJson(span.counters);
+        events.append(ev);
+    }
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QString Profiler::timeline(const QString &prefix) const {
+    // Spans are recorded when they end; list them by start so nested
+    // phases follow the phase that contains them.
+    QMutexLocker lock(&mutex);
+    QVector<Span> matching;
+    for (const Span &span : spans) {
+        if (QString::fromLatin1(span.name).startsWith(prefix)) matching << span;
+    }
+    std::sort(matching.begin(), matching.end(), [](const Span &a, const Span &b) { return a.startNs < b.startNs; });
+
+    QString out = QString("%1  %2  %3\n").arg("start ms", 9).arg("took ms", 9).arg("phase");
+    for (const Span &span : matching) {
+        out += QString("%1  %2  %3\n")
+                   .arg(span.startNs / 1e6, 9, 'f', 1)
+                   .arg(span.durationNs / 1e6, 9, 'f', 1)
+                   .arg(QString::fromLatin1(span.name));
+    }
+    return out;
+}
+
+void Profiler::reset() {
+    QMutexLocker lock(&mutex);
+    stageStats.clear();
+    spans.clear();
+    nextSpan = 0;
+    last.clear();
+}
@@ -0,0 +1,85 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QVector>
+
+// Always-on, low-overhead stage timing and counters. Stages are opened with
+// Profiler::Scope; counters are global and attributed to every scope that is
+// open while they change. Recent spans are kept in a ring buffer for export.
+class Profiler
+{
+public:
+    struct Counters {
+        qint64 bytesRead = 0;
+        qint64 filesProcessed = 0;
+        qint64 cacheHits = 0;
+        qint64 cacheMisses = 0;
+    };
+
+    struct StageStats {
+        qint64 calls = 0;
+        qint64 totalNs = 0;
+        qint64 lastNs = 0;
+        qint64 maxNs = 0;
+        Counters last;
+        Counters total;
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *name;
+        qint64 start;
+        Counters before;
+    };
+
+    static Profiler &instance();
+
+    void addBytesRead(qint64 bytes);
+    void addFileProcessed();
+    void addCacheHit();
+    void addCacheMiss();
+
+    QMap<QString, StageStats> stages() const;
+    QString lastStage() const;
+    QByteArray toJson() const;
+    QByteArray toChromeTrace() const;
+    QString timeline(const QString &prefix) const;
+    qint64 elapsedNs() const { return clock.nsecsElapsed(); }
+    void reset();
+
+private:
+    struct Span {
+        const char *name;
+        qint64 startNs;
+        qint64 durationNs;
+        Counters counters;
+    };
+
+    static const int maxSpans = 20000;
+
+    Profiler();
+    void record(const char *name, qint64 start, qint64 end, const Counters &before);
+    Counters snapshot() const;
+
+    mutable QMutex mutex;
+    QElapsedTimer clock;
+    Counters counters;
+    QMap<QString, StageStats> stageStats;
+    QVector<Span> spans;
+    int nextSpan;
+    QString last;
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include "scansnapshot.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QThread>
+#include <QSet>
+
+#include <algorithm>
+
+ScanSnapshot ScanSnapshot::scan(const QString &rootDir, const TraversalPolicy &policy) {
+    ScanSnapshot snap;
+    snap.rootDir = rootDir;
+
+    Node root;
+    root.name = QDir(rootDir).dirName();
+    root.isDir = true;
+    snap.nodes.append(root);
+
+    TraversalGuard guard(policy, rootDir);
+    snap.scanDir(0, rootDir, guard, 1);
+    snap.skipSummary = guard.summary();
+    snap.skipDetails = guard.details();
+
+    for (int i = snap.nodes.size() - 1; i > 0; --i) {
+        Node &node = snap.nodes[i];
+        if (!node.isDir) {
+            node.totalSize = node.size;
+            node.totalFiles = 1;
+        }
+        Node &parent = snap.nodes[node.parent];
+        parent.totalSize += node.totalSize;
+        parent.totalFiles += node.totalFiles;
+    }
+    return snap;
+}
+
+ScanSnapshot ScanSnapshot::scanWorkspace(const QStringList &roots, const TraversalPolicy &policy) {
+    if (roots.size() == 1) return scan(roots.first(), policy);
+
+    QVector<ScanSnapshot> parts(roots.size());
+    ScanSnapshot *out = parts.data();
+    QVector<QThread*> threads;
+    for (int i = 1; i < roots.size(); ++i) {
+        QThread *thread = QThread::create([out, &roots, &policy, i]() {
+            out[i] = scan(roots.at(i), policy);
+        });
+        thread->start();
+        threads << thread;
+    }
+    out[0] = scan(roots.first(), policy);
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    ScanSnapshot snap;
+    snap.rootDir = commonDir(roots);
+    if (snap.rootDir.isEmpty()) return snap;
+    Node top;
+    top.name = QDir(snap.rootDir).dirName();
+    top.isDir = true;
+    snap.nodes.append(top);
+
+    QStringList summaries;
+    const QDir base(snap.rootDir);
+    for (int i = 0; i < parts.size(); ++i) {
+        const ScanSnapshot &part = parts.at(i);
+        const QString mount = base.relativeFilePath(roots.at(i));
+        const int offset = snap.nodes.size();
+
+        for (int j = 0; j < part.nodes.size(); ++j) {
+            Node node = part.nodes.at(j);
+            if (j == 0) {
+                node.name = mount;
+                node.relPath = mount;
+                node.parent = 0;
+            } else {
+                node.relPath = mount + "/" + node.relPath;
+                node.parent += offset;
+            }
+            for (int &child : node.children) child += offset;
+            snap.index.insert(node.relPath, snap.nodes.size());
+            snap.nodes.append(node);
+        }
+
+        snap.nodes[0].children.append(offset);
+        snap.nodes[0].totalSize += part.nodes.at(0).totalSize;
+        snap.nodes[0].totalFiles += part.nodes.at(0).totalFiles;
+        snap.dirPaths += part.dirPaths;
+        snap.filePaths += part.filePaths;
+        if (!part.skipSummary.isEmpty()) summaries << mount + ": " + part.skipSummary;
+        snap.skipDetails += part.skipDetails;
+    }
+    snap.skipSummary = summaries.join("; ");
+    return snap;
+}
+
+QString ScanSnapshot::commonDir(const QStringList &roots) {
+    QStringList common = QDir::cleanPath(roots.first()).split('/');
+    for (const QString &root : roots) {
+        const QStringList parts = QDir::cleanPath(root).split('/');
+        int n = 0;
+        while (n < common.size() && n < parts.size() && common.at(n) == parts.at(n)) ++n;
+        common = common.mid(0, n);
+    }
+    // Nothing shared at all (roots on different drives): there is no
+    // directory every path can be made relative to.
+    if (common.isEmpty()) return QString();
+    QString dir = common.join('/');
+    if (dir.isEmpty() || dir.endsWith(':')) dir += '/';
+    return dir;
+}
+
+void ScanSnapshot::scanDir(int parent, const QString &path, TraversalGuard &guard, int depth) {
+    QDir dir(path);
+    dir.setFilter(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+    dir.setSorting(QDir::DirsFirst | QDir::Name);
+    const QString parentRel = nodes.at(parent).relPath;
+
+    for (const QFileInfo &info : dir.entryInfoList()) {
+        if (info.fileName().startsWith(".")) continue;
+        bool isDir = info.isDir();
+        if (isDir && guard.check(info, depth) != TraversalGuard::Enter) continue;
+
+        Node node;
+        node.name = info.fileName();
+        node.relPath = parentRel.isEmpty() ? node.name : parentRel + "/" + node.name;
+        node.isDir = isDir;
+        node.parent = parent;
+        if (!isDir) {
+            node.size = info.size();
+            node.modified = info.lastModified().toMSecsSinceEpoch();
+        }
+
+        int idx = nodes.size();
+        nodes.append(node);
+        nodes[parent].children.append(idx);
+        index.insert(node.relPath, idx);
+
+        if (isDir) {
+            dirPaths << info.filePath();
+            scanDir(idx, info.filePath(), guard, depth + 1);
+            guard.leave();
+        } else {
+            filePaths << info.filePath();
+        }
+    }
+}
+
+QString ScanSnapshot::filePath(int node) const {
+    const QString &rel = nodes.at(node).relPath;
+    if (rel.isEmpty()) return rootDir;
+    return rootDir.endsWith('/') ? rootDir + rel : rootDir + "/" + rel;
+}
+
+QStringList ScanSnapshot::relativeFiles() const {
+    QStringList files;
+    files.reserve(filePaths.size());
+    for (const Node &node : nodes) {
+        if (!node.isDir && !node.removed) files << node.relPath;
+    }
+    return files;
+}
+
+int ScanSnapshot::addFile(int parent, const QString &name, qint64 size, qint64 modified) {
+    Node node;
+    node.name = name;
+    node.relPath = nodes.at(parent).relPath.isEmpty() ? name : nodes.at(parent).relPath + "/" + name;
+    node.size = size;
+    node.modified = modified;
+    node.parent = parent;
+    node.totalSize = size;
+    node.totalFiles = 1;
+
+    const int idx = nodes.size();
+    nodes.append(node);
+    index.insert(node.relPath, idx);
+    filePaths << filePath(idx);
+
+    // Keep display order: directories first, then files by name.
+    QVector<int> &siblings = nodes[parent].children;
+    int pos = siblings.size();
+    for (int i = 0; i < siblings.size(); ++i) {
+        const Node &s = nodes.at(siblings.at(i));
+        if (!s.isDir && QString::compare(s.name, name) > 0) {
+            pos = i;
+            break;
+        }
+    }
+    siblings.insert(pos, idx);
+
+    for (int p = parent; p >= 0; p = nodes.at(p).parent) {
+        nodes[p].totalSize += size;
+        nodes[p].totalFiles += 1;
+    }
+    return idx;
+}
+
+QStringList ScanSnapshot::removeNodes(const QVector<int> &remove) {
+    // Removing a large subtree one path at a time would rescan both path
+    // lists per path; collect everything first and filter each list once.
+    QSet<int> tops;
+    QSet<int> parents;
+    for (int node : remove) {
+        const Node &n = nodes.at(node);
+        if (n.removed || n.parent < 0) continue;
+        tops.insert(node);
+        parents.insert(n.parent);
+        for (int p = n.parent; p >= 0; p = nodes.at(p).parent) {
+            nodes[p].totalSize -= n.totalSize;
+            nodes[p].totalFiles -= n.totalFiles;
+        }
+    }
+    QStringList removedFiles;
+    if (tops.isEmpty()) return removedFiles;
+
+    for (int parent : parents) {
+        QVector<int> &siblings = nodes[parent].children;
+        siblings.erase(std::remove_if(siblings.begin(), siblings.end(),
+                                      [&tops](int i) { return tops.contains(i); }),
+                       siblings.end());
+    }
+
+    QSet<QString> gone;
+    QVector<int> stack(tops.begin(), tops.end());
+    while (!stack.isEmpty()) {
+        int i = stack.takeLast();
+        nodes[i].removed = true;
+        index.remove(nodes.at(i).relPath);
+        gone.insert(filePath(i));
+        if (!nodes.at(i).isDir) removedFiles << nodes.at(i).relPath;
+        stack += nodes.at(i).children;
+    }
+    auto isGone = [&gone](const QString &path) { return gone.contains(path); };
+    dirPaths.erase(std::remove_if(dirPaths.begin(), dirPaths.end(), isGone), dirPaths.end());
+    filePaths.erase(std::remove_if(filePaths.begin(), filePaths.end(), isGone), filePaths.end());
+    return removedFiles;
+}
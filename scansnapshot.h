@@ -0,0 +1,63 @@
+#ifndef SCANSNAPSHOT_H
+#define SCANSNAPSHOT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+#include "traversalguard.h"
+
+// In-memory result of walking a project directory. Node 0 is the root;
+// children are stored in display order (directories first, then by name)
+// and always come after their parent, so totals can be folded bottom-up.
+class ScanSnapshot
+{
+public:
+    struct Node {
+        QString name;
+        QString relPath;
+        qint64 size = 0;
+        qint64 modified = 0;
+        int parent = -1;
+        bool isDir = false;
+        QVector<int> children;
+        qint64 totalSize = 0;
+        int totalFiles = 0;
+        bool removed = false;
+    };
+
+    static ScanSnapshot scan(const QString &rootDir, const TraversalPolicy &policy);
+
+    // Several project roots side by side. Each root is walked on its own
+    // thread with its own guard; the result is rooted at the deepest common
+    // directory, so every path starts with the root it came from. commonDir
+    // is empty, and so is the snapshot, when the roots share no ancestor.
+    static ScanSnapshot scanWorkspace(const QStringList &roots, const TraversalPolicy &policy);
+    static QString commonDir(const QStringList &roots);
+
+    QString rootDir;
+    QVector<Node> nodes;
+    QStringList dirPaths;
+    QStringList filePaths;
+    QString skipSummary;
+    QStringList skipDetails;
+
+    bool isEmpty() const { return nodes.isEmpty(); }
+    int indexOf(const QString &relPath) const { return index.value(relPath, -1); }
+    QString filePath(int node) const;
+    QStringList relativeFiles() const;
+
+    // In-place updates for a single directory listing, so a created or
+    // deleted file does not require walking the whole tree again.
+    // removeNodes returns the relative paths of the files that went away.
+    int addFile(int parent, const QString &name, qint64 size, qint64 modified);
+    QStringList removeNodes(const QVector<int> &nodes);
+
+private:
+    QHash<QString, int> index;
+
+    void scanDir(int parent, const QString &path, TraversalGuard &guard, int depth);
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "selectionprofile.h"
+
+QVariantMap SelectionProfile::toVariant() const {
+    QVariantMap map;
+    map["include"] = include;
+    map["exclude"] = exclude;
+    map["extensions"] = extensions;
+    map["paths"] = paths;
+    map["minSize"] = minSize;
+    map["maxSize"] = maxSize;
+    return map;
+}
+
+SelectionProfile SelectionProfile::fromVariant(const QVariantMap &map) {
+    SelectionProfile p;
+    p.include = map.value("include").toStringList();
+    p.exclude = map.value("exclude").toStringList();
+    p.extensions = map.value("extensions").toStringList();
+    p.paths = map.value("paths").toStringList();
+    p.minSize = map.value("minSize").toLongLong();
+    p.maxSize = map.value("maxSize").toLongLong();
+    return p;
+}
+
+ProfileMatcher::ProfileMatcher(const SelectionProfile &profile)
+    : include(profile.include), exclude(profile.exclude),
+      minSize(profile.minSize), maxSize(profile.maxSize)
+{
+    for (const QString &ext : profile.extensions) {
+        QString e = ext.trimmed().toLower();
+        while (e.startsWith('.') || e.startsWith('*')) e.remove(0, 1);
+        if (!e.isEmpty()) extensions.insert(e);
+    }
+    for (const QString &path : profile.paths) {
+        if (!path.trimmed().isEmpty()) paths.insert(path.trimmed());
+    }
+    // Without include globs or extensions only the explicit paths are selected;
+    // exclusions and size limits narrow a selection, they never make one.
+    hasRules = !include.isEmpty() || !extensions.isEmpty();
+    active = hasRules || !paths.isEmpty();
+}
+
+bool ProfileMatcher::matches(const QString &relPath, qint64 size) const {
+    if (!active) return false;
+    if (paths.contains(relPath)) return true;
+    if (!hasRules) return false;
+
+    if (minSize > 0 && size < minSize) return false;
+    if (maxSize > 0 && size > maxSize) return false;
+    if (!extensions.isEmpty()) {
+        int slash = relPath.lastIndexOf('/');
+        int dot = relPath.lastIndexOf('.');
+        if (dot <= slash + 1 || !extensions.contains(relPath.mid(dot + 1).toLower())) return false;
+    }
+    if (!include.isEmpty() && !include.matches(relPath)) return false;
+    return !exclude.matches(relPath);
+}
@@ -0,0 +1,48 @@
+#ifndef SELECTIONPROFILE_H
+#define SELECTIONPROFILE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QSet>
+
+#include "globmatcher.h"
+
+// A named, rule-based selection. A file is selected when it is listed
+// explicitly, or when it passes every rule that is set: include globs,
+// extensions, size limits, and none of the exclude globs.
+struct SelectionProfile {
+    QStringList include;
+    QStringList exclude;
+    QStringList extensions;
+    QStringList paths;
+    qint64 minSize = 0;
+    qint64 maxSize = 0;
+
+    QVariantMap toVariant() const;
+    static SelectionProfile fromVariant(const QVariantMap &map);
+};
+
+// A SelectionProfile compiled for repeated matching: the globs become one
+// regular expression each, extensions and explicit paths become sets.
+class ProfileMatcher
+{
+public:
+    ProfileMatcher() = default;
+    explicit ProfileMatcher(const SelectionProfile &profile);
+
+    bool isActive() const { return active; }
+    bool matches(const QString &relPath, qint64 size) const;
+
+private:
+    GlobMatcher include;
+    GlobMatcher exclude;
+    QSet<QString> extensions;
+    QSet<QString> paths;
+    qint64 minSize = 0;
+    qint64 maxSize = 0;
+    bool hasRules = false;
+    bool active = false;
+};
+
+#endif
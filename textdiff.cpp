@@ -0,0 +1,132 @@
+#include "textdiff.h"
+
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+namespace {
+
+struct Op {
+    char kind;
+    int a;
+    int b;
+};
+
+QStringList splitLines(const QString &text) {
+    QStringList lines = text.split('\n');
+    if (text.endsWith('\n')) lines.removeLast();
+    return lines;
+}
+
+}
+
+bool TextDiff::unified(const QString &oldText, const QString &newText, const QString &path,
+                       QString *out, int context, int maxEdits) {
+    out->clear();
+    if (oldText == newText) return true;
+
+    const QStringList a = splitLines(oldText);
+    const QStringList b = splitLines(newText);
+    QVector<uint> ha(a.size());
+    QVector<uint> hb(b.size());
+    for (int i = 0; i < a.size(); ++i) ha[i] = qHash(a.at(i));
+    for (int i = 0; i < b.size(); ++i) hb[i] = qHash(b.at(i));
+    auto equal = [&](int i, int j) { return ha.at(i) == hb.at(j) && a.at(i) == b.at(j); };
+
+    int prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && equal(prefix, prefix)) ++prefix;
+    int suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix
+           && equal(a.size() - 1 - suffix, b.size() - 1 - suffix)) ++suffix;
+
+    const int n = a.size() - prefix - suffix;
+    const int m = b.size() - prefix - suffix;
+    const int maxD = qMin(n + m, maxEdits);
+    const int offset = maxD + 1;
+
+    // Forward search. Round d only reads diagonals -d-1..d+1 of the previous
+    // frontier, so that slice is all the backtrack needs to keep.
+    QVector<int> v(2 * maxD + 3, 0);
+    QVector<QVector<int>> trace;
+    int found = -1;
+    for (int d = 0; d <= maxD && found < 0; ++d) {
+        trace.append(v.mid(offset - d - 1, 2 * d + 3));
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v.at(offset + k - 1) < v.at(offset + k + 1)))
+                        ? v.at(offset + k + 1)
+                        : v.at(offset + k - 1) + 1;
+            int y = x - k;
+            while (x < n && y < m && equal(prefix + x, prefix + y)) { ++x; ++y; }
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                found = d;
+                break;
+            }
+        }
+    }
+    if (found < 0) return false;
+
+    QVector<Op> middle;
+    int x = n;
+    int y = m;
+    for (int d = found; d >= 0; --d) {
+        const QVector<int> &pv = trace.at(d);
+        const int base = d + 1;
+        int k = x - y;
+        int prevK = (k == -d || (k != d && pv.at(base + k - 1) < pv.at(base + k + 1))) ? k + 1 : k - 1;
+        int prevX = pv.at(base + prevK);
+        int prevY = prevX - prevK;
+        while (x > prevX && y > prevY) {
+            --x; --y;
+            middle.append({' ', prefix + x, prefix + y});
+        }
+        if (d > 0) {
+            if (x == prevX) middle.append({'+', prefix + x, prefix + prevY});
+            else middle.append({'-', prefix + prevX, prefix + y});
+        }
+        x = prevX;
+        y = prevY;
+    }
+
+    QVector<Op> ops;
+    ops.reserve(prefix + middle.size() + suffix);
+    for (int i = 0; i < prefix; ++i) ops.append({' ', i, i});
+    for (int i = middle.size() - 1; i >= 0; --i) ops.append(middle.at(i));
+    for (int i = 0; i < suffix; ++i) ops.append({' ', a.size() - suffix + i, b.size() - suffix + i});
+
+    *out += "--- a/" + path + "\n+++ b/" + path + "\n";
+    bool hasHunk = false;
+    int i = 0;
+    while (i < ops.size()) {
+        if (ops.at(i).kind == ' ') { ++i; continue; }
+
+        int start = qMax(0, i - context);
+        int last = i;
+        for (int j = i + 1; j < ops.size() && j - last <= 2 * context; ++j) {
+            if (ops.at(j).kind != ' ') last = j;
+        }
+        int end = qMin(ops.size(), last + context + 1);
+
+        int aCount = 0;
+        int bCount = 0;
+        QString body;
+        for (int j = start; j < end; ++j) {
+            const Op &op = ops.at(j);
+            if (op.kind != '+') ++aCount;
+            if (op.kind != '-') ++bCount;
+            body += QChar(op.kind);
+            body += (op.kind == '+') ? b.at(op.b) : a.at(op.a);
+            body += '\n';
+        }
+        const Op &first = ops.at(start);
+        *out += QString("@@ -%1,%2 +%3,%4 @@\n")
+                    .arg(aCount ? first.a + 1 : first.a).arg(aCount)
+                    .arg(bCount ? first.b + 1 : first.b).arg(bCount);
+        *out += body;
+        hasHunk = true;
+        i = end;
+    }
+    // Texts that differ only in a trailing newline have no line-level hunk.
+    if (!hasHunk) out->clear();
+    return hasHunk;
+}
@@ -0,0 +1,18 @@
+#ifndef TEXTDIFF_H
+#define TEXTDIFF_H
+
+#include <QString>
+
+// Line-based unified diff (Myers' O(ND) algorithm). Common leading and
+// trailing lines are trimmed before the search, so a small edit in a large
+// file costs little more than comparing the two texts once.
+class TextDiff
+{
+public:
+    // Writes a unified diff of oldText -> newText to out. Returns false when
+    // more than maxEdits lines differ; callers then send the full new text.
+    static bool unified(const QString &oldText, const QString &newText, const QString &path,
+                        QString *out, int context = 3, int maxEdits = 1000);
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "traversalguard.h"
+
+#include <QDir>
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#else
+#include <QStorageInfo>
+#endif
+
+static const int maxReportedSkips = 50;
+
+TraversalGuard::TraversalGuard(const TraversalPolicy &policy, const QString &rootDir)
+    : policy(policy), rootDir(rootDir), canonicalRoot(QFileInfo(rootDir).canonicalFilePath()), rootDevice(0)
+{
+    for (int &count : skipCounts) count = 0;
+    FileId id;
+    if (identify(rootDir, id)) {
+        rootDevice = id.first;
+        visited.insert(id);
+    }
+    ancestors.append(id);
+}
+
+bool TraversalGuard::identify(const QString &path, FileId &id) const {
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0) return false;
+    id = FileId(quint64(st.st_dev), quint64(st.st_ino));
+    return true;
+#else
+    // No inode numbers here: the canonical path identifies the directory and
+    // the volume root stands in for the device.
+    QString canonical = QFileInfo(path).canonicalFilePath();
+    if (canonical.isEmpty()) return false;
+    quint64 device = policy.sameFilesystem ? qHash(QStorageInfo(canonical).rootPath()) : 0;
+    id = FileId(device, qHash(canonical));
+    return true;
+#endif
+}
+
+TraversalGuard::Decision TraversalGuard::check(const QFileInfo &dir, int depth) {
+    if (dir.isSymLink() && !policy.followSymlinks) return skip(SkipSymlink, dir);
+    if (policy.maxDepth > 0 && depth > policy.maxDepth) return skip(SkipDepth, dir);
+
+    FileId id;
+    if (!identify(dir.filePath(), id)) return skip(SkipUnreadable, dir);
+    if (policy.sameFilesystem && id.first != rootDevice) return skip(SkipMount, dir);
+    if (ancestors.contains(id)) return skip(SkipLoop, dir);
+    // Whichever path comes first in the walk, the real one should win, so a
+    // link into the project is dropped even before its target is seen.
+    if (dir.isSymLink() && reachedDirectly(dir)) return skip(SkipDuplicate, dir);
+    if (visited.contains(id)) return skip(SkipDuplicate, dir);
+
+    visited.insert(id);
+    ancestors.append(id);
+    return Enter;
+}
+
+void TraversalGuard::leave() {
+    if (ancestors.size() > 1) ancestors.removeLast();
+}
+
+// True when the link points at a directory inside the root that the walk
+// visits through its real path (hidden directories are never walked).
+bool TraversalGuard::reachedDirectly(const QFileInfo &link) const {
+    const QString target = link.canonicalFilePath();
+    if (target.isEmpty() || canonicalRoot.isEmpty()) return false;
+    const QString rel = QDir(canonicalRoot).relativeFilePath(target);
+    if (rel == "." || rel == ".." || rel.startsWith("../") || QDir::isAbsolutePath(rel)) return false;
+    for (const QString &part : rel.split('/')) {
+        if (part.startsWith(".")) return false;
+    }
+    return true;
+}
+
+TraversalGuard::Decision TraversalGuard::skip(Decision reason, const QFileInfo &dir) {
+    skipCounts[reason]++;
+    if (skipped.size() < maxReportedSkips) {
+        static const char *reasons[] = {"", "symlink not followed", "symlink loop",
+                                        "duplicate of a directory listed elsewhere", "other filesystem",
+                                        "maximum depth reached", "unreadable"};
+        skipped << QDir(rootDir).relativeFilePath(dir.filePath()) + " — " + reasons[reason];
+    }
+    return reason;
+}
+
+bool TraversalGuard::hasSkips() const {
+    for (int i = SkipSymlink; i <= SkipUnreadable; ++i) {
+        if (skipCounts[i] > 0) return true;
+    }
+    return false;
+}
+
+QString TraversalGuard::summary() const {
+    QStringList parts;
+    if (skipCounts[SkipLoop]) parts << QString("%1 loop(s)").arg(skipCounts[SkipLoop]);
+    if (skipCounts[SkipDuplicate]) parts << QString("%1 duplicate(s)").arg(skipCounts[SkipDuplicate]);
+    if (skipCounts[SkipMount]) parts << QString("%1 mount(s)").arg(skipCounts[SkipMount]);
+    if (skipCounts[SkipSymlink]) parts << QString("%1 symlink(s)").arg(skipCounts[SkipSymlink]);
+    if (skipCounts[SkipDepth]) parts << QString("%1 too deep").arg(skipCounts[SkipDepth]);
+    if (skipCounts[SkipUnreadable]) parts << QString("%1 unreadable").arg(skipCounts[SkipUnreadable]);
+    return parts.isEmpty() ? QString() : "Skipped " + parts.join(", ");
+}
+
+QStringList TraversalGuard::details() const {
+    return skipped;
+}
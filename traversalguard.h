@@ -0,0 +1,53 @@
+#ifndef TRAVERSALGUARD_H
+#define TRAVERSALGUARD_H
+
+#include <QString>
+#include <QStringList>
+#include <QFileInfo>
+#include <QSet>
+#include <QPair>
+#include <QVector>
+
+struct TraversalPolicy {
+    bool followSymlinks = true;
+    bool sameFilesystem = true;
+    int maxDepth = 64;
+};
+
+// Decides whether a directory walk may descend into a directory. Directories
+// are identified by (device, inode). A directory that is one of its own
+// ancestors is a loop; a symlink to a directory the walk reaches anyway, or a
+// second path to an already visited directory, is skipped as a duplicate so
+// its files are listed once, under their real path.
+class TraversalGuard
+{
+public:
+    enum Decision { Enter, SkipSymlink, SkipLoop, SkipDuplicate, SkipMount, SkipDepth, SkipUnreadable };
+
+    TraversalGuard(const TraversalPolicy &policy, const QString &rootDir);
+
+    // Every Enter must be paired with a leave() once the directory is done.
+    Decision check(const QFileInfo &dir, int depth);
+    void leave();
+    bool hasSkips() const;
+    QString summary() const;
+    QStringList details() const;
+
+private:
+    typedef QPair<quint64, quint64> FileId;
+
+    TraversalPolicy policy;
+    QString rootDir;
+    QString canonicalRoot;
+    quint64 rootDevice;
+    QVector<FileId> ancestors;
+    QSet<FileId> visited;
+    int skipCounts[SkipUnreadable + 1];
+    QStringList skipped;
+
+    bool identify(const QString &path, FileId &id) const;
+    bool reachedDirectly(const QFileInfo &link) const;
+    Decision skip(Decision reason, const QFileInfo &dir);
+};
+
+#endif
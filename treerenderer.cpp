@@ -0,0 +1,153 @@
+#include "treerenderer.h"
+#include "minifier.h"
+
+#include <QLocale>
+
+#include <limits>
+
+static qint64 lineCost(const QString &line) {
+    return Minifier::estimateTokens(line) + 1;
+}
+
+TreeRenderer::TreeRenderer(const ScanSnapshot &snapshot, const TreeRenderOptions &options)
+    : snap(snapshot), opts(options), lines(0), tokens(0), summarising(false), omitted(false),
+      omittedFiles(0), omittedBytes(0)
+{
+    const qint64 unlimited = std::numeric_limits<qint64>::max();
+    // Room for the longest trailer render() can produce.
+    const qint64 trailerTokens = lineCost("… (tree budget reached: 9,999,999 more files (999.9 MB) not shown)");
+
+    lineCap[Listing] = lineCap[Summary] = unlimited;
+    if (opts.maxLines > 0) {
+        lineCap[Summary] = qMax<qint64>(0, opts.maxLines - 1);
+        lineCap[Listing] = qMax<qint64>(0, lineCap[Summary] - opts.maxLines / 10);
+    }
+    tokenCap[Listing] = tokenCap[Summary] = unlimited;
+    if (opts.maxTokens > 0) {
+        tokenCap[Summary] = qMax<qint64>(0, opts.maxTokens - trailerTokens);
+        tokenCap[Listing] = qMax<qint64>(0, tokenCap[Summary] - opts.maxTokens / 10);
+    }
+}
+
+QString TreeRenderer::render(const ScanSnapshot &snapshot, const TreeRenderOptions &options, const QSet<QString> &selected) {
+    if (snapshot.isEmpty()) return QString();
+
+    TreeRenderer r(snapshot, options);
+    if (options.selectedOnly) {
+        r.keep.fill(false, snapshot.nodes.size());
+        r.keep[0] = true;
+        for (const QString &rel : selected) {
+            int idx = snapshot.indexOf(rel);
+            while (idx >= 0 && !r.keep.at(idx)) {
+                r.keep[idx] = true;
+                idx = snapshot.nodes.at(idx).parent;
+            }
+        }
+    }
+
+    r.renderDir(0, "", 1);
+    if (r.omitted) {
+        r.out += r.omittedFiles > 0
+            ? "… (tree budget reached: " + summary(r.omittedFiles, r.omittedBytes, "more ") + " not shown)\n"
+            : QString("… (tree budget reached)\n");
+    }
+    return r.out;
+}
+
+QString TreeRenderer::summary(int files, qint64 bytes, const QString &qualifier) {
+    // Fixed locale keeps the output byte-identical across machines.
+    QLocale locale(QLocale::English);
+    return QString("%1 %2%3 (%4)")
+        .arg(locale.toString(files))
+        .arg(qualifier)
+        .arg(files == 1 ? "file" : "files")
+        .arg(locale.formattedDataSize(bytes, 0, QLocale::DataSizeTraditionalFormat));
+}
+
+bool TreeRenderer::appendLine(const QString &line, Phase phase) {
+    qint64 cost = opts.maxTokens > 0 ? lineCost(line) : 0;
+    if (lines + 1 > lineCap[phase] || tokens + cost > tokenCap[phase]) return false;
+    out += line;
+    out += '\n';
+    lines++;
+    tokens += cost;
+    return true;
+}
+
+void TreeRenderer::omit(int files, qint64 bytes) {
+    omitted = true;
+    omittedFiles += files;
+    omittedBytes += bytes;
+}
+
+void TreeRenderer::renderDir(int node, const QString &prefix, int depth) {
+    const ScanSnapshot::Node &dir = snap.nodes.at(node);
+
+    QVector<int> shown;
+    int hiddenFiles = 0;
+    qint64 hiddenBytes = 0;
+    for (int child : dir.children) {
+        if (keep.isEmpty() || keep.at(child)) {
+            shown << child;
+        } else {
+            hiddenFiles += snap.nodes.at(child).totalFiles;
+            hiddenBytes += snap.nodes.at(child).totalSize;
+        }
+    }
+    if (opts.maxEntriesPerDir > 0 && shown.size() > opts.maxEntriesPerDir) {
+        for (int i = opts.maxEntriesPerDir; i < shown.size(); ++i) {
+            hiddenFiles += snap.nodes.at(shown.at(i)).totalFiles;
+            hiddenBytes += snap.nodes.at(shown.at(i)).totalSize;
+        }
+        shown.resize(opts.maxEntriesPerDir);
+    }
+    bool hasSummary = hiddenFiles > 0;
+
+    int i = 0;
+    for (; i < shown.size() && !summarising; ++i) {
+        const ScanSnapshot::Node &child = snap.nodes.at(shown.at(i));
+        bool last = (i == shown.size() - 1) && !hasSummary;
+        bool collapsed = child.isDir && !child.children.isEmpty() && opts.maxDepth > 0 && depth >= opts.maxDepth;
+
+        QString line = prefix + (last ? "└── " : "├── ") + child.name;
+        if (collapsed) line += " (… " + summary(child.totalFiles, child.totalSize) + ")";
+        if (!appendLine(line, Listing)) {
+            summarising = true;
+            break;
+        }
+        if (child.isDir && !collapsed) {
+            renderDir(shown.at(i), prefix + (last ? "    " : "│   "), depth + 1);
+        }
+    }
+
+    // Out of budget: what is left here is summarised from the snapshot
+    // totals, one line per directory and one for the loose files.
+    if (i < shown.size()) {
+        int lastDir = -1;
+        for (int j = i; j < shown.size(); ++j) {
+            const ScanSnapshot::Node &child = snap.nodes.at(shown.at(j));
+            if (child.isDir) {
+                lastDir = j;
+            } else {
+                hiddenFiles += 1;
+                hiddenBytes += child.size;
+            }
+        }
+        hasSummary = hiddenFiles > 0;
+        for (int j = i; j < shown.size(); ++j) {
+            const ScanSnapshot::Node &child = snap.nodes.at(shown.at(j));
+            if (!child.isDir) continue;
+            bool last = j == lastDir && !hasSummary;
+            QString line = prefix + (last ? "└── " : "├── ") + child.name + " (… " + summary(child.totalFiles, child.totalSize) + ")";
+            if (!appendLine(line, Summary)) omit(child.totalFiles, child.totalSize);
+        }
+    }
+
+    if (hasSummary) {
+        QString line = prefix + "└── … " + summary(hiddenFiles, hiddenBytes, shown.isEmpty() ? QString() : "more ");
+        if (!appendLine(line, summarising ? Summary : Listing)) {
+            summarising = true;
+            if (!appendLine(line, Summary)) omit(hiddenFiles, hiddenBytes);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef TREERENDERER_H
+#define TREERENDERER_H
+
+#include <QString>
+#include <QSet>
+
+#include "scansnapshot.h"
+
+struct TreeRenderOptions {
+    int maxLines = 0;
+    int maxTokens = 0;
+    int maxDepth = 0;
+    int maxEntriesPerDir = 0;
+    bool selectedOnly = false;
+};
+
+// Renders the ASCII tree from a ScanSnapshot under a line/token budget.
+// Directories that are too large or too deep collapse into a one-line
+// summary instead of being listed entry by entry. Once the budget runs out,
+// directories not yet reached are summarised the same way from the snapshot
+// totals; the last tenth of the budget is held back for those summaries and
+// one more line for a trailer counting whatever still did not fit. Zero
+// means unlimited.
+class TreeRenderer
+{
+public:
+    static QString render(const ScanSnapshot &snapshot, const TreeRenderOptions &options, const QSet<QString> &selected = QSet<QString>());
+
+private:
+    TreeRenderer(const ScanSnapshot &snapshot, const TreeRenderOptions &options);
+
+    const ScanSnapshot &snap;
+    TreeRenderOptions opts;
+    QVector<bool> keep;
+    QString out;
+    qint64 lines;
+    qint64 tokens;
+    // Caps for listing entries and for summary lines; the rest is the trailer's.
+    qint64 lineCap[2];
+    qint64 tokenCap[2];
+    bool summarising;
+    bool omitted;
+    int omittedFiles;
+    qint64 omittedBytes;
+
+    enum Phase { Listing, Summary };
+
+    void renderDir(int node, const QString &prefix, int depth);
+    bool appendLine(const QString &line, Phase phase);
+    void omit(int files, qint64 bytes);
+    static QString summary(int files, qint64 bytes, const QString &qualifier = QString());
+};
+
+#endif
@@ -0,0 +1,318 @@
+#include "viewporthighlighter.h"
+
+#include <QPlainTextEdit>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSet>
+#include <QHash>
+
+struct SyntaxRules {
+    QSet<QString> keywords;
+    QString lineComment;
+    bool blockComments;
+    bool preprocessor;
+    bool singleQuoteStrings;
+    bool tripleQuotes;
+    bool backtickStrings;
+};
+
+namespace {
+
+enum State { Normal, BlockComment, TripleDouble, TripleSingle, Backtick };
+
+// Half of a 60 Hz frame, leaving the rest for layout and painting.
+const qint64 frameBudgetMs = 8;
+const int viewportMargin = 40;
+
+const SyntaxRules *rulesFor(const QString &fileName) {
+    static const SyntaxRules cpp{{
+        "alignas", "alignof", "auto", "bool", "break", "case", "catch", "char", "class", "const",
+        "constexpr", "const_cast", "continue", "decltype", "default", "delete", "do", "double",
+        "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "final", "float",
+        "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new",
+        "noexcept", "nullptr", "operator", "override", "private", "protected", "public", "register",
+        "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert",
+        "static_cast", "struct", "switch", "template", "this", "throw", "true", "try", "typedef",
+        "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "while"
+    }, "//", true, true, false, false, false};
+    static const SyntaxRules java{{
+        "abstract", "assert", "boolean", "break", "byte", "case", "catch", "char", "class", "const",
+        "continue", "default", "do", "double", "else", "enum", "extends", "false", "final", "finally",
+        "float", "for", "if", "implements", "import", "instanceof", "int", "interface", "long",
+        "native", "new", "null", "package", "private", "protected", "public", "record", "return",
+        "short", "static", "super", "switch", "synchronized", "this", "throw", "throws", "transient",
+        "true", "try", "var", "void", "volatile", "while"
+    }, "//", true, false, false, false, false};
+    static const SyntaxRules js{{
+        "abstract", "as", "async", "await", "break", "case", "catch", "class", "const", "continue",
+        "debugger", "declare", "default", "delete", "do", "else", "enum", "export", "extends",
+        "false", "finally", "for", "from", "function", "if", "implements", "import", "in",
+        "instanceof", "interface", "let", "namespace", "new", "null", "of", "private", "protected",
+        "public", "readonly", "return", "static", "super", "switch", "this", "throw", "true", "try",
+        "type", "typeof", "undefined", "var", "void", "while", "with", "yield"
+    }, "//", true, false, true, false, true};
+    static const SyntaxRules go{{
+        "break", "case", "chan", "const", "continue", "default", "defer", "else", "fallthrough",
+        "false", "for", "func", "go", "goto", "if", "import", "interface", "iota", "map", "nil",
+        "package", "range", "return", "select", "struct", "switch", "true", "type", "var"
+    }, "//", true, false, false, false, true};
+    static const SyntaxRules rust{{
+        "as", "async", "await", "break", "const", "continue", "crate", "dyn", "else", "enum",
+        "extern", "false", "fn", "for", "if", "impl", "in", "let", "loop", "match", "mod", "move",
+        "mut", "pub", "ref", "return", "self", "Self", "static", "struct", "super", "trait", "true",
+        "type", "unsafe", "use", "where", "while"
+    }, "//", true, false, false, false, false};
+    static const SyntaxRules python{{
+        "False", "None", "True", "and", "as", "assert", "async", "await", "break", "class",
+        "continue", "def", "del", "elif", "else", "except", "finally", "for", "from", "global",
+        "if", "import", "in", "is", "lambda", "nonlocal", "not", "or", "pass", "raise", "return",
+        "self", "try", "while", "with", "yield"
+    }, "#", false, false, true, true, false};
+    static const SyntaxRules shell{{
+        "case", "do", "done", "elif", "else", "esac", "export", "fi", "for", "function", "if",
+        "in", "local", "return", "then", "until", "while"
+    }, "#", false, false, true, false, false};
+    static const SyntaxRules css{{}, QString(), true, false, true, false, false};
+    static const SyntaxRules json{{"true", "false", "null"}, QString(), false, false, false, false, false};
+
+    static const QHash<QString, const SyntaxRules *> byExtension = {
+        {"c", &cpp}, {"h", &cpp}, {"cc", &cpp}, {"cpp", &cpp}, {"cxx", &cpp}, {"hpp", &cpp},
+        {"hh", &cpp}, {"hxx", &cpp}, {"ipp", &cpp}, {"inl", &cpp},
+        {"java", &java}, {"kt", &java}, {"cs", &java},
+        {"js", &js}, {"jsx", &js}, {"mjs", &js}, {"cjs", &js},
+        {"ts", &js}, {"tsx", &js}, {"mts", &js}, {"cts", &js},
+        {"go", &go}, {"rs", &rust}, {"py", &python}, {"pyi", &python},
+        {"sh", &shell}, {"bash", &shell}, {"zsh", &shell},
+        {"css", &css}, {"scss", &css}, {"json", &json}
+    };
+    return byExtension.value(QFileInfo(fileName).suffix().toLower(), nullptr);
+}
+
+bool startsWithAt(const QString &s, int i, const QString &token) {
+    if (token.isEmpty() || i + token.size() > s.size()) return false;
+    for (int k = 0; k < token.size(); ++k) {
+        if (s.at(i + k) != token.at(k)) return false;
+    }
+    return true;
+}
+
+// Index just past the closing quote, or -1 when the line ends first.
+int quoteEnd(const QString &s, int from, QChar quote) {
+    for (int j = from; j < s.size(); ++j) {
+        if (s.at(j) == '\\') { ++j; continue; }
+        if (s.at(j) == quote) return j + 1;
+    }
+    return -1;
+}
+
+}
+
+ViewportHighlighter::ViewportHighlighter(QPlainTextEdit *editor)
+    : QObject(editor), editor(editor)
+{
+    timer.setSingleShot(true);
+    timer.setInterval(0);
+    connect(&timer, &QTimer::timeout, this, &ViewportHighlighter::work);
+    connect(editor->document(), &QTextDocument::contentsChange, this, &ViewportHighlighter::onContentsChange);
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, &ViewportHighlighter::schedule);
+    connect(editor->verticalScrollBar(), &QScrollBar::rangeChanged, this, &ViewportHighlighter::schedule);
+    setDarkTheme(false);
+}
+
+bool ViewportHighlighter::supports(const QString &fileName) {
+    return rulesFor(fileName) != nullptr;
+}
+
+void ViewportHighlighter::setFileName(const QString &fileName) {
+    rules = rulesFor(fileName);
+    reset();
+}
+
+void ViewportHighlighter::setDarkTheme(bool dark) {
+    const char *colors[TokenCount] = {
+        dark ? "#cc7832" : "#0033b3",
+        dark ? "#6a8759" : "#067d17",
+        dark ? "#808080" : "#8c8c8c",
+        dark ? "#6897bb" : "#1750eb",
+        dark ? "#bbb529" : "#9e880d"
+    };
+    for (int t = 0; t < TokenCount; ++t) {
+        formats[t] = QTextCharFormat();
+        formats[t].setForeground(QColor(colors[t]));
+    }
+    formatted.fill(false);
+    schedule();
+}
+
+void ViewportHighlighter::onContentsChange() {
+    // The preview is read-only, so any change is a new file.
+    reset();
+}
+
+void ViewportHighlighter::reset() {
+    knownUntil = 0;
+    formatted.fill(false, editor->document()->blockCount());
+    schedule();
+}
+
+void ViewportHighlighter::schedule() {
+    if (rules && !timer.isActive()) timer.start();
+}
+
+void ViewportHighlighter::work() {
+    if (!rules) return;
+    QElapsedTimer clock;
+    clock.start();
+
+    QTextDocument *doc = editor->document();
+    const int count = doc->blockCount();
+    if (formatted.size() != count) formatted.fill(false, count);
+
+    const int top = editor->cursorForPosition(QPoint(0, 0)).blockNumber();
+    const int bottom = editor->cursorForPosition(QPoint(editor->viewport()->width() - 1, editor->viewport()->height() - 1)).blockNumber();
+    const int first = qMax(0, top - viewportMargin);
+    const int last = qMin(count - 1, bottom + viewportMargin);
+
+    // Record end states up to the given block; false when out of time.
+    auto advance = [&](int until) {
+        QTextBlock block = doc->findBlockByNumber(knownUntil);
+        int state = (knownUntil > 0) ? block.previous().userState() : Normal;
+        while (block.isValid() && knownUntil <= until) {
+            if ((knownUntil & 63) == 0 && clock.elapsed() >= frameBudgetMs) return false;
+            state = lexLine(block.text(), state, nullptr);
+            block.setUserState(state);
+            block = block.next();
+            ++knownUntil;
+        }
+        return true;
+    };
+
+    if (!advance(last)) {
+        timer.start();
+        return;
+    }
+
+    QTextBlock block = doc->findBlockByNumber(first);
+    for (int n = first; n <= last && block.isValid(); ++n, block = block.next()) {
+        if (formatted.at(n)) continue;
+        QVector<QTextLayout::FormatRange> ranges;
+        lexLine(block.text(), (n > 0) ? block.previous().userState() : Normal, &ranges);
+        block.layout()->setFormats(ranges);
+        doc->markContentsDirty(block.position(), block.length());
+        formatted[n] = true;
+        if (clock.elapsed() >= frameBudgetMs) {
+            timer.start();
+            return;
+        }
+    }
+
+    // The viewport is done; keep carrying state towards the end of the file
+    // so that jumping there can be formatted straight away.
+    if (!advance(count - 1)) timer.start();
+}
+
+int ViewportHighlighter::lexLine(const QString &text, int state, QVector<QTextLayout::FormatRange> *out) const {
+    const int n = text.size();
+    auto mark = [&](int start, int end, Token token) {
+        if (out && end > start) out->append({start, end - start, formats[token]});
+    };
+
+    int i = 0;
+    if (state == BlockComment) {
+        int end = text.indexOf("*/");
+        if (end < 0) { mark(0, n, Comment); return BlockComment; }
+        mark(0, end + 2, Comment);
+        i = end + 2;
+    } else if (state == TripleDouble || state == TripleSingle) {
+        QString quote(3, state == TripleDouble ? '"' : '\'');
+        int end = text.indexOf(quote);
+        if (end < 0) { mark(0, n, String); return state; }
+        mark(0, end + 3, String);
+        i = end + 3;
+    } else if (state == Backtick) {
+        int end = quoteEnd(text, 0, '`');
+        if (end < 0) { mark(0, n, String); return Backtick; }
+        mark(0, end, String);
+        i = end;
+    } else if (rules->preprocessor) {
+        int k = 0;
+        while (k < n && text.at(k).isSpace()) ++k;
+        if (k < n && text.at(k) == '#') {
+            int end = n;
+            for (int j = k; j + 1 < n; ++j) {
+                if (text.at(j) == '/' && (text.at(j + 1) == '/' || text.at(j + 1) == '*')) { end = j; break; }
+            }
+            mark(k, end, Preprocessor);
+            i = end;
+        }
+    }
+
+    while (i < n) {
+        QChar c = text.at(i);
+        QChar next = (i + 1 < n) ? text.at(i + 1) : QChar();
+
+        if (startsWithAt(text, i, rules->lineComment)) {
+            mark(i, n, Comment);
+            return Normal;
+        }
+        if (rules->blockComments && c == '/' && next == '*') {
+            int end = text.indexOf("*/", i + 2);
+            if (end < 0) { mark(i, n, Comment); return BlockComment; }
+            mark(i, end + 2, Comment);
+            i = end + 2;
+            continue;
+        }
+        if (c == '"' || (c == '\'' && rules->singleQuoteStrings)) {
+            if (rules->tripleQuotes && i + 2 < n && next == c && text.at(i + 2) == c) {
+                int end = text.indexOf(QString(3, c), i + 3);
+                if (end < 0) { mark(i, n, String); return c == '"' ? TripleDouble : TripleSingle; }
+                mark(i, end + 3, String);
+                i = end + 3;
+                continue;
+            }
+            int end = quoteEnd(text, i + 1, c);
+            if (end < 0) end = n;
+            mark(i, end, String);
+            i = end;
+            continue;
+        }
+        if (c == '\'') {
+            // Character literal; anything else (Rust lifetimes, digit separators) is plain text.
+            int end = -1;
+            if (next == '\\') {
+                int close = text.indexOf('\'', i + 3);
+                if (close > 0 && close - i <= 12) end = close + 1;
+            } else if (i + 2 < n && text.at(i + 2) == '\'') {
+                end = i + 3;
+            }
+            if (end < 0) { ++i; continue; }
+            mark(i, end, String);
+            i = end;
+            continue;
+        }
+        if (c == '`' && rules->backtickStrings) {
+            int end = quoteEnd(text, i + 1, '`');
+            if (end < 0) { mark(i, n, String); return Backtick; }
+            mark(i, end, String);
+            i = end;
+            continue;
+        }
+        if (c.isLetter() || c == '_') {
+            int start = i;
+            while (i < n && (text.at(i).isLetterOrNumber() || text.at(i) == '_')) ++i;
+            if (out && rules->keywords.contains(text.mid(start, i - start))) mark(start, i, Keyword);
+            continue;
+        }
+        if (c.isDigit()) {
+            int start = i;
+            while (i < n && (text.at(i).isLetterOrNumber() || text.at(i) == '.' || text.at(i) == '_')) ++i;
+            mark(start, i, Number);
+            continue;
+        }
+        ++i;
+    }
+    return Normal;
+}
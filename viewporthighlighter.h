@@ -0,0 +1,52 @@
+#ifndef VIEWPORTHIGHLIGHTER_H
+#define VIEWPORTHIGHLIGHTER_H
+
+#include <QObject>
+#include <QTextCharFormat>
+#include <QTextLayout>
+#include <QTimer>
+#include <QVector>
+
+class QPlainTextEdit;
+struct SyntaxRules;
+
+// Syntax highlighting for the preview pane that only ever formats the blocks
+// on screen plus a small margin. The lexer state at the end of each block is
+// kept in the block's user state and extended forward a slice at a time from
+// a zero-interval timer, so no single event-loop turn runs longer than the
+// frame budget however large the file is.
+class ViewportHighlighter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ViewportHighlighter(QPlainTextEdit *editor);
+
+    void setFileName(const QString &fileName);
+    void setDarkTheme(bool dark);
+
+    static bool supports(const QString &fileName);
+
+private slots:
+    void onContentsChange();
+    void work();
+
+private:
+    enum Token { Keyword, String, Comment, Number, Preprocessor, TokenCount };
+
+    QPlainTextEdit *editor;
+    const SyntaxRules *rules = nullptr;
+    QTextCharFormat formats[TokenCount];
+    QTimer timer;
+
+    // Blocks before knownUntil have their end state recorded; formatted
+    // marks blocks whose formats match the current rules and theme.
+    int knownUntil = 0;
+    QVector<bool> formatted;
+
+    void reset();
+    void schedule();
+    int lexLine(const QString &text, int state, QVector<QTextLayout::FormatRange> *out) const;
+};
+
+#endif